@@ -0,0 +1,265 @@
+#include <Rcpp.h>
+#include <R_ext/Altrep.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "R_altrep.h"
+#include "R_utils.h"
+#include "type_sequence_container.h"
+
+namespace {
+
+R_altrep_class_t types_class;
+R_altrep_class_t offsets_class;
+R_altrep_class_t tokens_class;
+
+// The state behind a view on an encoded corpus. Views keep the corpus alive
+// but not unchanged: if its vocabulary is pruned, they refuse to be read.
+struct CorpusView {
+  const TypeSequenceContainer* corpus;
+  TypeSequenceContainer::size_type generation;
+  R_xlen_t n_tokens;
+  R_xlen_t n_offsets;
+};
+
+struct TokensView {
+  Alphabet::SPtr alphabet;
+  std::vector<const std::string*> tokens;
+};
+
+template <typename T>
+T* view(SEXP x) {
+  return static_cast<T*>(R_ExternalPtrAddr(R_altrep_data1(x)));
+}
+
+bool is_materialized(SEXP x) {
+  return R_altrep_data2(x) != R_NilValue;
+}
+
+const CorpusView& checked_corpus_view(SEXP x) {
+  const CorpusView& corpus_view = *view<CorpusView>(x);
+
+  if (corpus_view.corpus->generation() != corpus_view.generation)
+    Rf_error("the corpus has changed since this vector was created");
+
+  return corpus_view;
+}
+
+SEXP create_corpus_view(R_altrep_class_t cls, SEXP corpus) {
+  Rcpp::XPtr<TypeSequenceContainer> container = unwrap_type_sequence_container(corpus);
+
+  CorpusView* corpus_view = new CorpusView{container.get(),
+                                           container->generation(),
+                                           static_cast<R_xlen_t>(container->n_tokens()),
+                                           static_cast<R_xlen_t>(container->offsets().size())};
+
+  // The view's pointer protects the corpus from the garbage collector.
+  Rcpp::XPtr<CorpusView> data(corpus_view, true, R_NilValue, corpus);
+  return R_new_altrep(cls, data, R_NilValue);
+}
+
+// Types: the buffer is read directly. Compact types go up to 2^32 - 2, but
+// only corpora whose types are all below 2^31 get such a vector, so that
+// their 32-bit pattern is the same as a nonnegative R integer's.
+
+R_xlen_t types_length(SEXP x) {
+  return view<CorpusView>(x)->n_tokens;
+}
+
+const void* types_dataptr_or_null(SEXP x) {
+  if (is_materialized(x)) return DATAPTR(R_altrep_data2(x));
+  return checked_corpus_view(x).corpus->data();
+}
+
+void* types_dataptr(SEXP x, Rboolean writeable) {
+  if (!is_materialized(x)) {
+    const CorpusView& corpus_view = checked_corpus_view(x);
+    if (!writeable) return const_cast<TypeSequenceContainer::CompactType*>(corpus_view.corpus->data());
+
+    SEXP values = PROTECT(Rf_allocVector(INTSXP, corpus_view.n_tokens));
+    std::memcpy(INTEGER(values), corpus_view.corpus->data(), corpus_view.n_tokens * sizeof(int));
+    R_set_altrep_data2(x, values);
+    UNPROTECT(1);
+  }
+
+  return DATAPTR(R_altrep_data2(x));
+}
+
+int types_elt(SEXP x, R_xlen_t i) {
+  if (is_materialized(x)) return INTEGER(R_altrep_data2(x))[i];
+  return checked_corpus_view(x).corpus->data()[i];
+}
+
+R_xlen_t types_get_region(SEXP x, R_xlen_t start, R_xlen_t size, int* out) {
+  const int* values = static_cast<const int*>(types_dataptr_or_null(x));
+  R_xlen_t n = std::min(size, types_length(x) - start);
+
+  std::memcpy(out, values + start, n * sizeof(int));
+  return n;
+}
+
+// Offsets: 64-bit integers are converted element by element.
+
+R_xlen_t offsets_length(SEXP x) {
+  return view<CorpusView>(x)->n_offsets;
+}
+
+void* offsets_dataptr(SEXP x, Rboolean) {
+  if (!is_materialized(x)) {
+    const CorpusView& corpus_view = checked_corpus_view(x);
+    const TypeSequenceContainer::Offsets& offsets = corpus_view.corpus->offsets();
+
+    SEXP values = PROTECT(Rf_allocVector(REALSXP, corpus_view.n_offsets));
+    std::copy(offsets.cbegin(), offsets.cend(), REAL(values));
+    R_set_altrep_data2(x, values);
+    UNPROTECT(1);
+  }
+
+  return DATAPTR(R_altrep_data2(x));
+}
+
+const void* offsets_dataptr_or_null(SEXP x) {
+  return is_materialized(x) ? DATAPTR(R_altrep_data2(x)) : nullptr;
+}
+
+double offsets_elt(SEXP x, R_xlen_t i) {
+  if (is_materialized(x)) return REAL(R_altrep_data2(x))[i];
+  return checked_corpus_view(x).corpus->offsets()[i];
+}
+
+R_xlen_t offsets_get_region(SEXP x, R_xlen_t start, R_xlen_t size, double* out) {
+  R_xlen_t n = std::min(size, offsets_length(x) - start);
+  for (R_xlen_t i = 0; i < n; ++i) out[i] = offsets_elt(x, start + i);
+  return n;
+}
+
+// Tokens: strings are made into R strings when they are read.
+
+R_xlen_t tokens_length(SEXP x) {
+  return view<TokensView>(x)->tokens.size();
+}
+
+SEXP token(const std::string& value) {
+  return Rf_mkCharLenCE(value.data(), value.size(), CE_UTF8);
+}
+
+void* tokens_dataptr(SEXP x, Rboolean) {
+  if (!is_materialized(x)) {
+    const TokensView& tokens_view = *view<TokensView>(x);
+    R_xlen_t n = tokens_view.tokens.size();
+
+    SEXP values = PROTECT(Rf_allocVector(STRSXP, n));
+    for (R_xlen_t i = 0; i < n; ++i) SET_STRING_ELT(values, i, token(*tokens_view.tokens[i]));
+    R_set_altrep_data2(x, values);
+    UNPROTECT(1);
+  }
+
+  return DATAPTR(R_altrep_data2(x));
+}
+
+const void* tokens_dataptr_or_null(SEXP x) {
+  return is_materialized(x) ? DATAPTR(R_altrep_data2(x)) : nullptr;
+}
+
+SEXP tokens_elt(SEXP x, R_xlen_t i) {
+  if (is_materialized(x)) return STRING_ELT(R_altrep_data2(x), i);
+  return token(*view<TokensView>(x)->tokens[i]);
+}
+
+void tokens_set_elt(SEXP x, R_xlen_t i, SEXP value) {
+  tokens_dataptr(x, TRUE);
+  SET_STRING_ELT(R_altrep_data2(x), i, value);
+}
+
+// Serialization: the native buffers do not outlive the session, so the
+// vectors are saved as the ordinary R vectors they stand for and are read
+// back as such.
+
+SEXP types_serialized_state(SEXP x) {
+  R_xlen_t n = types_length(x);
+  SEXP values = PROTECT(Rf_allocVector(INTSXP, n));
+  types_get_region(x, 0, n, INTEGER(values));
+  UNPROTECT(1);
+  return values;
+}
+
+SEXP offsets_serialized_state(SEXP x) {
+  R_xlen_t n = offsets_length(x);
+  SEXP values = PROTECT(Rf_allocVector(REALSXP, n));
+  offsets_get_region(x, 0, n, REAL(values));
+  UNPROTECT(1);
+  return values;
+}
+
+SEXP tokens_serialized_state(SEXP x) {
+  R_xlen_t n = tokens_length(x);
+  SEXP values = PROTECT(Rf_allocVector(STRSXP, n));
+  for (R_xlen_t i = 0; i < n; ++i) SET_STRING_ELT(values, i, tokens_elt(x, i));
+  UNPROTECT(1);
+  return values;
+}
+
+SEXP unserialize(SEXP, SEXP state) {
+  return state;
+}
+
+}
+
+// [[Rcpp::init]]
+void register_altrep_classes(DllInfo* dll) {
+  types_class = R_make_altinteger_class("tomer_types", "tomer", dll);
+  R_set_altrep_Length_method(types_class, types_length);
+  R_set_altvec_Dataptr_method(types_class, types_dataptr);
+  R_set_altvec_Dataptr_or_null_method(types_class, types_dataptr_or_null);
+  R_set_altinteger_Elt_method(types_class, types_elt);
+  R_set_altinteger_Get_region_method(types_class, types_get_region);
+  R_set_altrep_Serialized_state_method(types_class, types_serialized_state);
+  R_set_altrep_Unserialize_method(types_class, unserialize);
+
+  offsets_class = R_make_altreal_class("tomer_offsets", "tomer", dll);
+  R_set_altrep_Length_method(offsets_class, offsets_length);
+  R_set_altvec_Dataptr_method(offsets_class, offsets_dataptr);
+  R_set_altvec_Dataptr_or_null_method(offsets_class, offsets_dataptr_or_null);
+  R_set_altreal_Elt_method(offsets_class, offsets_elt);
+  R_set_altreal_Get_region_method(offsets_class, offsets_get_region);
+  R_set_altrep_Serialized_state_method(offsets_class, offsets_serialized_state);
+  R_set_altrep_Unserialize_method(offsets_class, unserialize);
+
+  tokens_class = R_make_altstring_class("tomer_tokens", "tomer", dll);
+  R_set_altrep_Length_method(tokens_class, tokens_length);
+  R_set_altvec_Dataptr_method(tokens_class, tokens_dataptr);
+  R_set_altvec_Dataptr_or_null_method(tokens_class, tokens_dataptr_or_null);
+  R_set_altstring_Elt_method(tokens_class, tokens_elt);
+  R_set_altstring_Set_elt_method(tokens_class, tokens_set_elt);
+  R_set_altrep_Serialized_state_method(tokens_class, tokens_serialized_state);
+  R_set_altrep_Unserialize_method(tokens_class, unserialize);
+}
+
+SEXP create_altrep_types(SEXP corpus) {
+  Rcpp::XPtr<TypeSequenceContainer> container = unwrap_type_sequence_container(corpus);
+
+  for (auto const& entry : container->alphabet()) {
+    if (entry.first > static_cast<Alphabet::Type>(std::numeric_limits<int>::max()))
+      Rcpp::stop("the corpus has types beyond the range of R integers");
+  }
+
+  return create_corpus_view(types_class, corpus);
+}
+
+SEXP create_altrep_offsets(SEXP corpus) {
+  return create_corpus_view(offsets_class, corpus);
+}
+
+SEXP create_altrep_tokens(const Alphabet::SPtr& alphabet) {
+  TokensView* tokens_view = new TokensView{alphabet, {}};
+
+  tokens_view->tokens.reserve(alphabet->size());
+  for (auto const& entry : *alphabet) tokens_view->tokens.push_back(&entry.second);
+
+  Rcpp::XPtr<TokensView> data(tokens_view, true);
+  return R_new_altrep(tokens_class, data, R_NilValue);
+}
@@ -0,0 +1,23 @@
+#ifndef R_ALTREP_H
+#define R_ALTREP_H
+
+#include <Rcpp.h>
+
+#include "def.h"
+#include "alphabet.h"
+
+// R vectors that read native buffers in place instead of copying them. They
+// are only copied into ordinary R vectors when R needs to modify them.
+
+// Integer vector of the types of all tokens of an encoded corpus, which
+// must be the external pointer of a TypeSequenceContainer whose types are
+// below 2^31.
+SEXP create_altrep_types(SEXP corpus);
+
+// Numeric vector of the document offsets of an encoded corpus.
+SEXP create_altrep_offsets(SEXP corpus);
+
+// Character vector of the tokens of an alphabet in type order.
+SEXP create_altrep_tokens(const Alphabet::SPtr& alphabet);
+
+#endif // R_ALTREP_H
@@ -0,0 +1,85 @@
+#include <Rcpp.h>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "def.h"
+#include "alphabet.h"
+#include "checkpoint_diff.h"
+#include "R_utils.h"
+
+namespace {
+
+// The type-topic counts of a checkpoint with its types renumbered to those
+// of the same tokens in alphabet, which gains the tokens it lacks.
+CheckpointDiff::Counts create_counts_from_R(const Rcpp::DataFrame& checkpoint_alphabet,
+                                            const Rcpp::DataFrame& type_topic_counts,
+                                            Alphabet& alphabet) {
+  Alphabet own = create_alphabet_from_R(checkpoint_alphabet);
+
+  DoubleVector types = Rcpp::as<DoubleVector>(type_topic_counts["type"]);
+  TypeVector mapped(types.size());
+
+  for (std::size_t i = 0; i < types.size(); ++i) {
+    mapped[i] = alphabet.add(own.at(static_cast<Type>(types[i])));
+  }
+
+  DoubleVector counts = Rcpp::as<DoubleVector>(type_topic_counts["count"]);
+  CountVector _counts(counts.size());
+
+  for (std::size_t i = 0; i < counts.size(); ++i) {
+    if (!(counts[i] >= 0 && std::isfinite(counts[i])))
+      Rcpp::stop("type-topic counts must be nonnegative");
+    _counts[i] = static_cast<Count>(counts[i]);
+  }
+
+  return CheckpointDiff::Counts{alphabet.size(),
+                                mapped,
+                                Rcpp::as<IntVector>(type_topic_counts["topic"]),
+                                _counts};
+}
+
+}
+
+// [[Rcpp::export]]
+Rcpp::List diff_checkpoints_cpp(const Rcpp::DataFrame& alphabet_before,
+                                const Rcpp::DataFrame& type_topic_counts_before,
+                                const Rcpp::DataFrame& alphabet_after,
+                                const Rcpp::DataFrame& type_topic_counts_after,
+                                std::size_t n_topics,
+                                std::size_t n_top_types,
+                                std::size_t n_threads) {
+  Alphabet alphabet;
+
+  CheckpointDiff::Counts before = create_counts_from_R(alphabet_before, type_topic_counts_before, alphabet);
+  CheckpointDiff::Counts after = create_counts_from_R(alphabet_after, type_topic_counts_after, alphabet);
+
+  // Types that first occur in the later checkpoint extend the earlier one
+  // with empty rows.
+  before.row_offsets.resize(alphabet.size() + 1, before.row_offsets.back());
+
+  CheckpointDiff diff{n_topics};
+  CheckpointDiff::Result result = diff.compare(before, after, n_top_types, n_threads);
+
+  std::vector<std::string> token;
+  for (auto type : result.top_types) token.push_back(alphabet.at(type));
+
+  Rcpp::DataFrame topics = Rcpp::DataFrame::create(
+    Rcpp::Named("drift") = result.topic_drift,
+    Rcpp::Named("size_before") = std::vector<double>(result.topic_sizes_before.cbegin(),
+                                                     result.topic_sizes_before.cend()),
+    Rcpp::Named("size_after") = std::vector<double>(result.topic_sizes_after.cbegin(),
+                                                    result.topic_sizes_after.cend()));
+
+  Rcpp::DataFrame types = Rcpp::DataFrame::create(
+    Rcpp::Named("token") = token,
+    Rcpp::Named("shift") = std::vector<double>(result.top_type_shifts.cbegin(),
+                                               result.top_type_shifts.cend()),
+    Rcpp::Named("change") = std::vector<double>(result.top_type_changes.cbegin(),
+                                                result.top_type_changes.cend()),
+    Rcpp::Named("stringsAsFactors") = false);
+
+  return Rcpp::List::create(Rcpp::Named("topics") = topics,
+                            Rcpp::Named("types") = types,
+                            Rcpp::Named("total_shift") = static_cast<double>(result.total_shift));
+}
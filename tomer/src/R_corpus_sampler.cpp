@@ -0,0 +1,36 @@
+#include <Rcpp.h>
+#include <cstdint>
+#include <vector>
+
+#include "def.h"
+#include "alphabet.h"
+#include "corpus_sampler.h"
+#include "R_utils.h"
+#include "type_sequence_builder.h"
+#include "type_sequence_container.h"
+
+// [[Rcpp::export]]
+SEXP sample_corpus_cpp(const Rcpp::DataFrame& alphabet,
+                       std::size_t n_topics,
+                       const Rcpp::DataFrame& type_topic_counts,
+                       const Rcpp::NumericVector& alpha,
+                       double beta,
+                       const Rcpp::NumericVector& lengths,
+                       std::size_t n_threads,
+                       double seed) {
+  Alphabet _alphabet = create_alphabet_from_R(alphabet);
+  std::size_t n_types = _alphabet.size();
+
+  IntMatrix _type_topic_counts = create_type_topic_counts_from_R(type_topic_counts,
+                                                                 n_types,
+                                                                 n_topics);
+  DoubleVector _alpha = Rcpp::as<DoubleVector>(alpha);
+  CorpusSampler::LengthVector _lengths(lengths.begin(), lengths.end());
+
+  CorpusSampler sampler{n_topics, _alpha, beta, _type_topic_counts, n_threads};
+
+  TypeSequenceBuilder builder{std::move(_alphabet), true};
+  sampler.sample(_lengths, n_threads, static_cast<std::uint64_t>(seed), builder);
+
+  return wrap_type_sequence_container(builder.get_data());
+}
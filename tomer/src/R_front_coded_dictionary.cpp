@@ -0,0 +1,87 @@
+#include <Rcpp.h>
+#include <string>
+#include <vector>
+
+#include "front_coded_dictionary.h"
+#include "R_utils.h"
+
+using DictionaryPtr = Rcpp::XPtr<FrontCodedDictionary::SPtr>;
+
+namespace {
+
+const char* DICTIONARY_TAG = "tomer_dictionary";
+
+DictionaryPtr unwrap_dictionary(SEXP dictionary) {
+  return unwrap_external_pointer<FrontCodedDictionary::SPtr>(dictionary, DICTIONARY_TAG, "a dictionary");
+}
+
+}
+
+// [[Rcpp::export]]
+SEXP compress_alphabet_cpp(const Rcpp::DataFrame& alphabet,
+                           std::size_t block_size,
+                           bool hash) {
+  std::vector<double> types = Rcpp::as<std::vector<double>>(alphabet["type"]);
+  std::vector<std::string> tokens = Rcpp::as<std::vector<std::string>>(alphabet["token"]);
+
+  FrontCodedDictionary::SPtr dictionary{
+    new FrontCodedDictionary{tokens,
+                             std::vector<FrontCodedDictionary::Type>(types.cbegin(), types.cend()),
+                             block_size,
+                             hash}};
+
+  return wrap_external_pointer(new FrontCodedDictionary::SPtr{dictionary}, DICTIONARY_TAG);
+}
+
+// [[Rcpp::export]]
+SEXP open_dictionary_cpp(const std::string& path) {
+  return wrap_external_pointer(new FrontCodedDictionary::SPtr{FrontCodedDictionary::open(path)},
+                               DICTIONARY_TAG);
+}
+
+// [[Rcpp::export]]
+void save_dictionary_cpp(SEXP dictionary, const std::string& path) {
+  DictionaryPtr ptr = unwrap_dictionary(dictionary);
+  (*ptr)->save(path);
+}
+
+// [[Rcpp::export]]
+Rcpp::NumericVector dictionary_types_cpp(SEXP dictionary,
+                                         const std::vector<std::string>& tokens) {
+  DictionaryPtr ptr = unwrap_dictionary(dictionary);
+  const FrontCodedDictionary& d = **ptr;
+
+  Rcpp::NumericVector types(tokens.size());
+  for (std::size_t i = 0; i < tokens.size(); ++i) {
+    types[i] = d.has(tokens[i]) ? d.at(tokens[i]) : NA_REAL;
+  }
+
+  return types;
+}
+
+// [[Rcpp::export]]
+Rcpp::CharacterVector dictionary_tokens_cpp(SEXP dictionary,
+                                            const std::vector<double>& types) {
+  DictionaryPtr ptr = unwrap_dictionary(dictionary);
+  const FrontCodedDictionary& d = **ptr;
+
+  Rcpp::CharacterVector tokens(types.size());
+  for (std::size_t i = 0; i < types.size(); ++i) {
+    if (types[i] >= 0 && d.has(static_cast<FrontCodedDictionary::Type>(types[i])))
+      tokens[i] = d.at(static_cast<FrontCodedDictionary::Type>(types[i]));
+    else
+      tokens[i] = NA_STRING;
+  }
+
+  return tokens;
+}
+
+// [[Rcpp::export]]
+Rcpp::List dictionary_info_cpp(SEXP dictionary) {
+  DictionaryPtr ptr = unwrap_dictionary(dictionary);
+  const FrontCodedDictionary& d = **ptr;
+
+  return Rcpp::List::create(Rcpp::Named("size") = static_cast<double>(d.size()),
+                            Rcpp::Named("block_size") = static_cast<double>(d.block_size()),
+                            Rcpp::Named("bytes") = static_cast<double>(d.bytes()));
+}
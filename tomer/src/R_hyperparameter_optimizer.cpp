@@ -0,0 +1,33 @@
+#include <Rcpp.h>
+
+#include "def.h"
+#include "hyperparameter_optimizer.h"
+
+// [[Rcpp::export]]
+Rcpp::List optimize_hyperparameters_cpp(const Rcpp::DataFrame& state,
+                                        const Rcpp::DataFrame& type_topic_counts,
+                                        std::size_t n_topics,
+                                        std::size_t n_types,
+                                        std::size_t n_docs,
+                                        const Rcpp::NumericVector& alpha,
+                                        double beta,
+                                        std::size_t n_iterations,
+                                        double shape,
+                                        double scale) {
+  IntVector docs = Rcpp::as<IntVector>(state["doc"]);
+  IntVector topics = Rcpp::as<IntVector>(state["topic"]);
+
+  HyperparameterOptimizer optimizer{n_topics, n_types};
+  optimizer.add_documents(docs, topics, n_docs);
+  optimizer.add_type_topic_counts(Rcpp::as<IntVector>(type_topic_counts["topic"]),
+                                  Rcpp::as<CountVector>(type_topic_counts["count"]));
+
+  DoubleVector optimized_alpha = optimizer.optimize_alpha(Rcpp::as<DoubleVector>(alpha),
+                                                          n_iterations,
+                                                          shape,
+                                                          scale);
+  double optimized_beta = optimizer.optimize_beta(beta, n_iterations);
+
+  return Rcpp::List::create(Rcpp::Named("alpha") = optimized_alpha,
+                            Rcpp::Named("beta") = optimized_beta);
+}
@@ -0,0 +1,46 @@
+#include <Rcpp.h>
+#include <cstdint>
+
+#include "def.h"
+#include "alphabet.h"
+#include "importance_sampling_evaluator.h"
+#include "R_utils.h"
+#include "type_mapping.h"
+#include "type_sequence_container.h"
+#include "type_sequence_view.h"
+
+// The corpus is either encoded, in which case its types are translated to
+// the model's while evaluating, or a list of tokenized chunks, which are
+// encoded with the model's alphabet.
+// [[Rcpp::export]]
+Rcpp::NumericVector evaluate_importance_sampling_cpp(SEXP corpus,
+                                                     const Rcpp::DataFrame& alphabet,
+                                                     std::size_t n_topics,
+                                                     const Rcpp::DataFrame& topic_counts,
+                                                     const Rcpp::DataFrame& type_topic_counts,
+                                                     const Rcpp::NumericVector& alpha,
+                                                     double beta,
+                                                     std::size_t n_samples,
+                                                     std::size_t n_threads,
+                                                     double seed) {
+  Alphabet _alphabet = create_alphabet_from_R(alphabet);
+  std::size_t n_types = _alphabet.size();
+
+  CountVector _topic_counts = create_topic_counts_from_R(topic_counts, n_topics);
+  IntMatrix _type_topic_counts = create_type_topic_counts_from_R(type_topic_counts,
+                                                                 n_types,
+                                                                 n_topics);
+  DoubleVector _alpha = Rcpp::as<DoubleVector>(alpha);
+
+  ImportanceSamplingEvaluator evaluator{n_topics, _alpha, beta, _topic_counts, _type_topic_counts};
+  evaluator.set_seed(static_cast<std::uint64_t>(seed));
+
+  if (TYPEOF(corpus) == EXTPTRSXP) {
+    TypeSequenceView type_sequences = create_type_sequence_view_from_R(corpus);
+    evaluator.set_type_mapping(TypeMapping{type_sequences.alphabet(), _alphabet});
+    return Rcpp::wrap(evaluator.evaluate_documents(type_sequences, n_samples, n_threads));
+  }
+
+  TypeSequenceContainer type_sequences = create_type_sequences_from_R(Rcpp::List(corpus), _alphabet);
+  return Rcpp::wrap(evaluator.evaluate_documents(TypeSequenceView{type_sequences}, n_samples, n_threads));
+}
@@ -0,0 +1,97 @@
+#include <Rcpp.h>
+#include <string>
+#include <vector>
+
+#include "front_coded_dictionary.h"
+#include "inverted_index.h"
+#include "R_utils.h"
+
+// An index together with the dictionary of its reference corpus, which is
+// saved next to it.
+struct ReferenceIndex {
+  InvertedIndex::SPtr index;
+  FrontCodedDictionary::SPtr dictionary;
+};
+
+namespace {
+
+const char* INDEX_TAG = "tomer_reference_index";
+
+Rcpp::XPtr<ReferenceIndex> unwrap_reference_index(SEXP index) {
+  return unwrap_external_pointer<ReferenceIndex>(index, INDEX_TAG, "a reference index");
+}
+
+std::string dictionary_path(const std::string& path) {
+  return path + ".dict";
+}
+
+}
+
+// [[Rcpp::export]]
+void build_reference_index_cpp(SEXP corpus, const std::string& path, std::size_t n_threads) {
+  TypeSequenceView types = create_type_sequence_view_from_R(corpus);
+
+  InvertedIndex index{types, n_threads};
+  index.save(path);
+
+  FrontCodedDictionary dictionary{types.alphabet()};
+  dictionary.save(dictionary_path(path));
+}
+
+// [[Rcpp::export]]
+SEXP open_reference_index_cpp(const std::string& path) {
+  return wrap_external_pointer(new ReferenceIndex{InvertedIndex::open(path),
+                                                 FrontCodedDictionary::open(dictionary_path(path))},
+                               INDEX_TAG);
+}
+
+// [[Rcpp::export]]
+Rcpp::DataFrame co_document_frequencies_cpp(SEXP index,
+                                            const std::vector<std::string>& first,
+                                            const std::vector<std::string>& second,
+                                            std::size_t n_threads) {
+  Rcpp::XPtr<ReferenceIndex> reference = unwrap_reference_index(index);
+  const InvertedIndex& inverted = *reference->index;
+  const FrontCodedDictionary& dictionary = *reference->dictionary;
+
+  // Pairs with a token outside the reference corpus are looked up as the
+  // pair of type 0 with itself and reported as missing afterwards.
+  std::size_t n_pairs = first.size();
+  std::vector<std::size_t> first_types(n_pairs, 0);
+  std::vector<std::size_t> second_types(n_pairs, 0);
+  std::vector<bool> found(n_pairs, false);
+
+  for (std::size_t i = 0; i < n_pairs; ++i) {
+    if (!dictionary.has(first[i]) || !dictionary.has(second[i])) continue;
+
+    first_types[i] = dictionary.at(first[i]);
+    second_types[i] = dictionary.at(second[i]);
+    found[i] = first_types[i] < inverted.n_types() && second_types[i] < inverted.n_types();
+    if (!found[i]) first_types[i] = second_types[i] = 0;
+  }
+
+  CountVector co_frequencies = inverted.n_types() == 0 ?
+    CountVector(n_pairs, 0) : inverted.co_document_frequencies(first_types, second_types, n_threads);
+
+  std::vector<double> first_frequency(n_pairs, NA_REAL);
+  std::vector<double> second_frequency(n_pairs, NA_REAL);
+  std::vector<double> co_frequency(n_pairs, NA_REAL);
+
+  for (std::size_t i = 0; i < n_pairs; ++i) {
+    if (!found[i]) continue;
+
+    first_frequency[i] = inverted.document_frequency(first_types[i]);
+    second_frequency[i] = inverted.document_frequency(second_types[i]);
+    co_frequency[i] = co_frequencies[i];
+  }
+
+  return Rcpp::DataFrame::create(Rcpp::Named("first_frequency") = first_frequency,
+                                 Rcpp::Named("second_frequency") = second_frequency,
+                                 Rcpp::Named("co_frequency") = co_frequency);
+}
+
+// [[Rcpp::export]]
+double reference_index_documents_cpp(SEXP index) {
+  Rcpp::XPtr<ReferenceIndex> reference = unwrap_reference_index(index);
+  return reference->index->n_documents();
+}
@@ -0,0 +1,33 @@
+#include <Rcpp.h>
+
+#include "def.h"
+#include "joint_likelihood.h"
+#include "R_utils.h"
+
+// [[Rcpp::export]]
+Rcpp::List joint_log_likelihood_cpp(const Rcpp::DataFrame& state,
+                                    const Rcpp::DataFrame& topic_counts,
+                                    const Rcpp::DataFrame& type_topic_counts,
+                                    std::size_t n_topics,
+                                    std::size_t n_types,
+                                    std::size_t n_docs,
+                                    const Rcpp::NumericVector& alpha,
+                                    double beta,
+                                    std::size_t n_threads) {
+  IntVector docs = Rcpp::as<IntVector>(state["doc"]);
+  IntVector topics = Rcpp::as<IntVector>(state["topic"]);
+
+  CountVector _topic_counts = create_topic_counts_from_R(topic_counts, n_topics);
+  IntMatrix _type_topic_counts = create_type_topic_counts_from_R(type_topic_counts,
+                                                                 n_types,
+                                                                 n_topics);
+
+  JointLikelihood likelihood{n_topics, Rcpp::as<DoubleVector>(alpha), beta};
+  JointLikelihood::Result result = likelihood.compute(docs, topics, n_docs,
+                                                      _topic_counts, _type_topic_counts,
+                                                      n_threads);
+
+  return Rcpp::List::create(Rcpp::Named("log_likelihood") = result.log_likelihood,
+                            Rcpp::Named("topic_log_likelihood") = result.topic_log_likelihood,
+                            Rcpp::Named("word_log_likelihood") = result.word_log_likelihood);
+}
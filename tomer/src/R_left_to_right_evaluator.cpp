@@ -1,128 +1,313 @@
 #include <Rcpp.h>
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "def.h"
 #include "alphabet.h"
+#include "R_utils.h"
 #include "type_sequence_builder.h"
 #include "left_to_right_evaluator.h"
+#include "particle_state.h"
+#include "shared_model.h"
+#include "type_mapping.h"
 
-Corpus create_corpus_from_R(const Rcpp::DataFrame& corpus,
-                            std::size_t n_docs) {
-  Corpus c(n_docs);
-  Document current_doc;
+struct AttachedModel {
+  SharedModel::SPtr model;
+  Alphabet alphabet;
+};
 
-  IntVector doc_id = Rcpp::as<IntVector>(corpus["id"]);
-  StringVector doc_token = Rcpp::as<StringVector>(corpus["token"]);
+namespace {
 
-  std::size_t current_id = doc_id.at(0);
-  std::size_t previous_id = current_id;
-  current_doc.push_back(doc_token.at(0));
+const char* MODEL_TAG = "tomer_shared_model";
 
-  for (unsigned i = 1; i < doc_id.size(); ++i) {
-    current_id = doc_id.at(i);
-
-    if (current_id != previous_id) {
-      c.push_back(current_doc);
-      current_doc = Document{doc_token.at(i)};
-    } else {
-      current_doc.push_back(doc_token.at(i));
-    }
-
-    previous_id = current_id;
+// The corpus is either encoded, in which case its types are translated to
+// the model's while evaluating, or a list of tokenized chunks, which are
+// encoded with the model's alphabet into `tokenized`.
+std::unique_ptr<TypeSequenceView> create_evaluated_corpus_from_R(SEXP corpus,
+                                                                 const Alphabet& alphabet,
+                                                                 LeftToRightEvaluator& evaluator,
+                                                                 std::unique_ptr<TypeSequenceContainer>& tokenized) {
+  if (TYPEOF(corpus) == EXTPTRSXP) {
+    std::unique_ptr<TypeSequenceView> encoded{new TypeSequenceView{create_type_sequence_view_from_R(corpus)}};
+    evaluator.set_type_mapping(TypeMapping{encoded->alphabet(), alphabet});
+    return encoded;
   }
 
-  return c;
+  tokenized.reset(new TypeSequenceContainer{create_type_sequences_from_R(Rcpp::List(corpus), alphabet)});
+  return std::unique_ptr<TypeSequenceView>{new TypeSequenceView{*tokenized}};
 }
 
-Alphabet create_alphabet_from_R(const Rcpp::DataFrame& alphabet) {
-  std::map<Alphabet::Token, Alphabet::Type> a{};
-
-  IntVector types = Rcpp::as<IntVector>(alphabet["type"]);
-  StringVector tokens = Rcpp::as<StringVector>(alphabet["token"]);
+}
 
-  std::size_t type;
-  std::string token;
+// [[Rcpp::export]]
+Rcpp::NumericVector evaluate_left_to_right_cpp(const Rcpp::List& corpus,
+                                               const Rcpp::DataFrame& alphabet,
+                                               std::size_t n_topics,
+                                               const Rcpp::DataFrame& topic_counts,
+                                               const Rcpp::DataFrame& type_topic_counts,
+                                               const Rcpp::NumericVector& alpha,
+                                               double beta,
+                                               std::size_t n_particles,
+                                               bool resampling,
+                                               std::size_t n_threads,
+                                               const std::string& numa,
+                                               std::size_t n_lanes,
+                                               double seed) {
+  Alphabet _alphabet = create_alphabet_from_R(alphabet);
+  std::size_t n_types = _alphabet.size();
 
-  for (unsigned i = 0; i < types.size(); ++i) {
-    type = types.at(i);
-    token = tokens.at(i);
+  TypeSequenceContainer type_sequences = create_type_sequences_from_R(corpus, _alphabet);
 
-    a.insert(std::make_pair(token, type));
-  }
+  CountVector _topic_counts = create_topic_counts_from_R(topic_counts, n_topics);
+  IntMatrix _type_topic_counts = create_type_topic_counts_from_R(type_topic_counts,
+                                                                 n_types,
+                                                                 n_topics);
+  DoubleVector _alpha = Rcpp::as<DoubleVector>(alpha);
 
-  return Alphabet{a};
+  LeftToRightEvaluator evaluator{n_topics, _alpha, beta, _topic_counts, _type_topic_counts};
+  evaluator.set_parallelism(n_threads, create_numa_placement_from_R(numa));
+  evaluator.set_interleaving(n_lanes);
+  evaluator.set_seed(static_cast<std::uint64_t>(seed));
+  return Rcpp::wrap(evaluator.evaluate_documents(type_sequences, n_particles, resampling));
 }
 
-IntVector create_topic_counts_from_R(const Rcpp::DataFrame& topic_counts,
-                                     std::size_t n_topics) {
-  IntVector topics = Rcpp::as<IntVector>(topic_counts["topic"]);
-  IntVector counts = Rcpp::as<IntVector>(topic_counts["count"]);
-  IntVector tc(n_topics);
+// [[Rcpp::export]]
+Rcpp::NumericVector evaluate_left_to_right_encoded_cpp(SEXP corpus,
+                                                       const Rcpp::DataFrame& alphabet,
+                                                       std::size_t n_topics,
+                                                       const Rcpp::DataFrame& topic_counts,
+                                                       const Rcpp::DataFrame& type_topic_counts,
+                                                       const Rcpp::NumericVector& alpha,
+                                                       double beta,
+                                                       std::size_t n_particles,
+                                                       bool resampling,
+                                                       std::size_t n_threads,
+                                                       const std::string& numa,
+                                                       std::size_t n_lanes,
+                                                       double seed) {
+  TypeSequenceView type_sequences = create_type_sequence_view_from_R(corpus);
 
-  std::size_t topic, count;
+  Alphabet _alphabet = create_alphabet_from_R(alphabet);
+  std::size_t n_types = _alphabet.size();
 
-  for (unsigned i = 0; i < topics.size(); ++i) {
-    topic = topics.at(i);
-    count = counts.at(i);
-    tc.at(topic) = count;
-  }
+  CountVector _topic_counts = create_topic_counts_from_R(topic_counts, n_topics);
+  IntMatrix _type_topic_counts = create_type_topic_counts_from_R(type_topic_counts,
+                                                                 n_types,
+                                                                 n_topics);
+  DoubleVector _alpha = Rcpp::as<DoubleVector>(alpha);
 
-  return tc;
+  LeftToRightEvaluator evaluator{n_topics, _alpha, beta, _topic_counts, _type_topic_counts};
+  evaluator.set_parallelism(n_threads, create_numa_placement_from_R(numa));
+  evaluator.set_interleaving(n_lanes);
+  evaluator.set_seed(static_cast<std::uint64_t>(seed));
+
+  // The types of the encoded corpus, which may have been pruned since it was
+  // encoded, are translated to the model's while evaluating.
+  evaluator.set_type_mapping(TypeMapping{type_sequences.alphabet(), _alphabet});
+  return Rcpp::wrap(evaluator.evaluate_documents(type_sequences, n_particles, resampling));
 }
 
-IntMatrix create_type_topic_counts_from_R(const Rcpp::DataFrame& type_topic_counts,
-                                          std::size_t n_types,
-                                          std::size_t n_topics) {
-  IntMatrix ttc(n_types);
+// [[Rcpp::export]]
+Rcpp::List evaluate_left_to_right_diagnostics_cpp(const Rcpp::List& corpus,
+                                                  const Rcpp::DataFrame& alphabet,
+                                                  std::size_t n_topics,
+                                                  const Rcpp::DataFrame& topic_counts,
+                                                  const Rcpp::DataFrame& type_topic_counts,
+                                                  const Rcpp::NumericVector& alpha,
+                                                  double beta,
+                                                  std::size_t n_particles,
+                                                  bool resampling,
+                                                  std::size_t n_threads,
+                                                  double seed) {
+  Alphabet _alphabet = create_alphabet_from_R(alphabet);
+  std::size_t n_types = _alphabet.size();
+
+  TypeSequenceContainer type_sequences = create_type_sequences_from_R(corpus, _alphabet);
 
-  for (unsigned i = 0; i < n_types; ++i) {
-    ttc.at(i) = IntVector(n_topics, 0);
-  }
+  CountVector _topic_counts = create_topic_counts_from_R(topic_counts, n_topics);
+  IntMatrix _type_topic_counts = create_type_topic_counts_from_R(type_topic_counts,
+                                                                 n_types,
+                                                                 n_topics);
+  DoubleVector _alpha = Rcpp::as<DoubleVector>(alpha);
 
-  IntVector types = Rcpp::as<IntVector>(type_topic_counts["type"]);
-  IntVector topics = Rcpp::as<IntVector>(type_topic_counts["topic"]);
-  IntVector counts = Rcpp::as<IntVector>(type_topic_counts["count"]);
+  LeftToRightEvaluator evaluator{n_topics, _alpha, beta, _topic_counts, _type_topic_counts};
+  evaluator.set_parallelism(n_threads, NumaPlacement::NONE);
+  evaluator.set_diagnostics(true);
+  evaluator.set_seed(static_cast<std::uint64_t>(seed));
 
-  std::size_t type, topic, count;
+  double log_likelihood = evaluator.evaluate(type_sequences, n_particles, resampling);
 
-  for (unsigned i = 0; i < types.size(); ++i) {
-    type = types.at(i);
-    topic = topics.at(i);
-    count = counts.at(i);
+  TypeDiagnostics diagnostics = evaluator.diagnostics();
+  std::vector<double> type, log_probability, n_tokens;
+  type.reserve(diagnostics.size());
+  log_probability.reserve(diagnostics.size());
+  n_tokens.reserve(diagnostics.size());
 
-    ttc.at(type).at(topic) = count;
+  for (auto const& entry : diagnostics) {
+    type.push_back(entry.first);
+    log_probability.push_back(entry.second.log_probability);
+    n_tokens.push_back(entry.second.n_tokens);
   }
 
-  return ttc;
+  Rcpp::DataFrame types = Rcpp::DataFrame::create(Rcpp::Named("type") = type,
+                                                  Rcpp::Named("n_tokens") = n_tokens,
+                                                  Rcpp::Named("log_probability") = log_probability);
+
+  return Rcpp::List::create(Rcpp::Named("log_likelihood") = log_likelihood,
+                            Rcpp::Named("types") = types);
 }
 
 // [[Rcpp::export]]
-double evaluate_left_to_right_cpp(const Rcpp::DataFrame& corpus,
-                                  std::size_t n_docs,
-                                  const Rcpp::DataFrame& alphabet,
-                                  std::size_t n_topics,
-                                  const Rcpp::DataFrame& topic_counts,
-                                  const Rcpp::DataFrame& type_topic_counts,
-                                  const Rcpp::NumericVector& alpha,
-                                  double beta,
-                                  std::size_t n_particles,
-                                  bool resampling) {
-  Corpus _corpus = create_corpus_from_R(corpus, n_docs);
+Rcpp::List evaluate_left_to_right_anytime_cpp(SEXP corpus,
+                                              const Rcpp::DataFrame& alphabet,
+                                              std::size_t n_topics,
+                                              const Rcpp::DataFrame& topic_counts,
+                                              const Rcpp::DataFrame& type_topic_counts,
+                                              const Rcpp::NumericVector& alpha,
+                                              double beta,
+                                              std::size_t n_particles,
+                                              bool resampling,
+                                              double seconds,
+                                              std::size_t n_threads,
+                                              const std::string& numa,
+                                              double seed) {
   Alphabet _alphabet = create_alphabet_from_R(alphabet);
   std::size_t n_types = _alphabet.size();
 
-  TypeSequenceBuilder builder{std::move(_alphabet), true};
-  builder.add(_corpus);
+  CountVector _topic_counts = create_topic_counts_from_R(topic_counts, n_topics);
+  IntMatrix _type_topic_counts = create_type_topic_counts_from_R(type_topic_counts,
+                                                                 n_types,
+                                                                 n_topics);
+  DoubleVector _alpha = Rcpp::as<DoubleVector>(alpha);
+
+  LeftToRightEvaluator evaluator{n_topics, _alpha, beta, _topic_counts, _type_topic_counts};
+  evaluator.set_parallelism(n_threads, create_numa_placement_from_R(numa));
+  evaluator.set_seed(static_cast<std::uint64_t>(seed));
+
+  std::unique_ptr<TypeSequenceContainer> tokenized;
+  std::unique_ptr<TypeSequenceView> type_sequences = create_evaluated_corpus_from_R(corpus,
+                                                                                   _alphabet,
+                                                                                   evaluator,
+                                                                                   tokenized);
+
+  LeftToRightEvaluator::AnytimeResult result = evaluator.evaluate_anytime(*type_sequences,
+                                                                          n_particles,
+                                                                          resampling,
+                                                                          seconds);
+
+  return Rcpp::List::create(Rcpp::Named("log_likelihood") = result.log_likelihood,
+                            Rcpp::Named("standard_error") = result.standard_error,
+                            Rcpp::Named("n_docs") = static_cast<double>(result.n_docs),
+                            Rcpp::Named("n_docs_evaluated") = static_cast<double>(result.n_docs_evaluated),
+                            Rcpp::Named("n_tokens") = static_cast<double>(result.n_tokens),
+                            Rcpp::Named("n_tokens_evaluated") = static_cast<double>(result.n_tokens_evaluated),
+                            Rcpp::Named("min_particles") = static_cast<double>(result.min_particles),
+                            Rcpp::Named("n_evaluations") = static_cast<double>(result.n_evaluations),
+                            Rcpp::Named("complete") = result.complete,
+                            Rcpp::Named("seconds") = result.seconds);
+}
 
-  TypeSequenceContainer type_sequences = builder.get_data();
+// [[Rcpp::export]]
+Rcpp::List evaluate_left_to_right_resumable_cpp(const Rcpp::List& corpus,
+                                                const Rcpp::DataFrame& alphabet,
+                                                std::size_t n_topics,
+                                                const Rcpp::DataFrame& topic_counts,
+                                                const Rcpp::DataFrame& type_topic_counts,
+                                                const Rcpp::NumericVector& alpha,
+                                                double beta,
+                                                std::size_t n_particles,
+                                                bool resampling,
+                                                const Rcpp::List& particle_states,
+                                                double seed) {
+  Alphabet _alphabet = create_alphabet_from_R(alphabet);
+  std::size_t n_types = _alphabet.size();
 
-  IntVector _topic_counts = create_topic_counts_from_R(topic_counts, n_topics);
+  TypeSequenceContainer type_sequences = create_type_sequences_from_R(corpus, _alphabet);
+
+  CountVector _topic_counts = create_topic_counts_from_R(topic_counts, n_topics);
   IntMatrix _type_topic_counts = create_type_topic_counts_from_R(type_topic_counts,
                                                                  n_types,
                                                                  n_topics);
   DoubleVector _alpha = Rcpp::as<DoubleVector>(alpha);
 
   LeftToRightEvaluator evaluator{n_topics, _alpha, beta, _topic_counts, _type_topic_counts};
-  return evaluator.evaluate(type_sequences, n_particles, resampling);
+  evaluator.set_seed(static_cast<std::uint64_t>(seed));
+
+  std::size_t n_docs = type_sequences.size();
+  Rcpp::NumericVector log_likelihood(n_docs);
+  Rcpp::List states(n_docs);
+
+  for (std::size_t i = 0; i < n_docs; ++i) {
+    DocumentState state;
+
+    if (i < static_cast<std::size_t>(particle_states.size()) && !Rf_isNull(particle_states[i])) {
+      Rcpp::RawVector raw = particle_states[i];
+      state = DocumentState::deserialize(std::string(raw.begin(), raw.end()));
+    }
+
+    log_likelihood[i] = evaluator.evaluate(type_sequences.at(i), n_particles, resampling, state, i);
+
+    std::string data = state.serialize();
+    states[i] = Rcpp::RawVector(data.begin(), data.end());
+  }
+
+  return Rcpp::List::create(Rcpp::Named("log_likelihood") = log_likelihood,
+                            Rcpp::Named("particle_states") = states);
+}
+
+// [[Rcpp::export]]
+void export_shared_model_cpp(const std::string& name,
+                             const Rcpp::DataFrame& alphabet,
+                             std::size_t n_topics,
+                             const Rcpp::DataFrame& topic_counts,
+                             const Rcpp::DataFrame& type_topic_counts,
+                             const Rcpp::NumericVector& alpha,
+                             double beta) {
+  Alphabet _alphabet = create_alphabet_from_R(alphabet);
+  std::size_t n_types = _alphabet.size();
+
+  CountVector _topic_counts = create_topic_counts_from_R(topic_counts, n_topics);
+  IntMatrix _type_topic_counts = create_type_topic_counts_from_R(type_topic_counts,
+                                                                 n_types,
+                                                                 n_topics);
+  DoubleVector _alpha = Rcpp::as<DoubleVector>(alpha);
+
+  SharedModel::create(name, _alphabet, _alpha, beta, _topic_counts, _type_topic_counts);
+}
+
+// [[Rcpp::export]]
+SEXP attach_shared_model_cpp(const std::string& name) {
+  SharedModel::SPtr model = SharedModel::attach(name);
+
+  return wrap_external_pointer(new AttachedModel{model, model->alphabet()}, MODEL_TAG);
+}
+
+// [[Rcpp::export]]
+bool remove_shared_model_cpp(const std::string& name) {
+  return SharedModel::remove(name);
+}
+
+// [[Rcpp::export]]
+double evaluate_left_to_right_shared_cpp(SEXP corpus,
+                                         SEXP model,
+                                         std::size_t n_particles,
+                                         bool resampling,
+                                         std::size_t n_threads,
+                                         const std::string& numa,
+                                         double seed) {
+  Rcpp::XPtr<AttachedModel> attached = unwrap_external_pointer<AttachedModel>(model, MODEL_TAG,
+                                                                                 "an attached shared model");
+
+  LeftToRightEvaluator evaluator{attached->model};
+  evaluator.set_parallelism(n_threads, create_numa_placement_from_R(numa));
+  evaluator.set_seed(static_cast<std::uint64_t>(seed));
+
+  std::unique_ptr<TypeSequenceContainer> tokenized;
+  std::unique_ptr<TypeSequenceView> type_sequences = create_evaluated_corpus_from_R(corpus,
+                                                                                   attached->alphabet,
+                                                                                   evaluator,
+                                                                                   tokenized);
+  return evaluator.evaluate(*type_sequences, n_particles, resampling);
 }
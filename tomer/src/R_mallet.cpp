@@ -0,0 +1,60 @@
+#include <Rcpp.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "def.h"
+#include "mallet.h"
+
+// [[Rcpp::export]]
+Rcpp::List read_mallet_word_topic_counts_cpp(const std::string& path,
+                                             std::size_t n_topics,
+                                             std::size_t n_threads) {
+  WordTopicCounts model = WordTopicCounts::read_mallet(path, n_topics, n_threads);
+
+  std::vector<double> alphabet_type;
+  std::vector<std::string> alphabet_token;
+  alphabet_type.reserve(model.n_types());
+  alphabet_token.reserve(model.n_types());
+
+  for (auto const& entry : model.alphabet) {
+    alphabet_type.push_back(entry.first);
+    alphabet_token.push_back(entry.second);
+  }
+
+  std::vector<double> topic(model.n_topics);
+  std::vector<double> topic_count(model.topic_counts.cbegin(), model.topic_counts.cend());
+  for (std::size_t t = 0; t < model.n_topics; ++t) topic[t] = t;
+
+  std::vector<double> type(model.topics.size());
+  for (std::size_t t = 0; t < model.n_types(); ++t) {
+    std::fill(type.begin() + model.row_offsets[t], type.begin() + model.row_offsets[t + 1], t);
+  }
+
+  Rcpp::DataFrame alphabet = Rcpp::DataFrame::create(Rcpp::Named("type") = alphabet_type,
+                                                     Rcpp::Named("token") = alphabet_token,
+                                                     Rcpp::Named("stringsAsFactors") = false);
+  Rcpp::DataFrame topic_counts = Rcpp::DataFrame::create(Rcpp::Named("topic") = topic,
+                                                         Rcpp::Named("count") = topic_count);
+  Rcpp::DataFrame type_topic_counts = Rcpp::DataFrame::create(Rcpp::Named("type") = type,
+                                                              Rcpp::Named("topic") = model.topics,
+                                                              Rcpp::Named("count") = model.counts);
+
+  return Rcpp::List::create(Rcpp::Named("alphabet") = alphabet,
+                            Rcpp::Named("topic_counts") = topic_counts,
+                            Rcpp::Named("type_topic_counts") = type_topic_counts,
+                            Rcpp::Named("n_topics") = static_cast<double>(model.n_topics));
+}
+
+// [[Rcpp::export]]
+Rcpp::List read_mallet_topic_keys_cpp(const std::string& path) {
+  TopicKeys topic_keys = TopicKeys::read_mallet(path);
+
+  Rcpp::List keys(topic_keys.keys.size());
+  for (std::size_t topic = 0; topic < topic_keys.keys.size(); ++topic) {
+    keys[topic] = topic_keys.keys[topic];
+  }
+
+  return Rcpp::List::create(Rcpp::Named("alpha") = topic_keys.alpha,
+                            Rcpp::Named("keys") = keys);
+}
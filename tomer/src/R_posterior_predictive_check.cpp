@@ -0,0 +1,35 @@
+#include <Rcpp.h>
+
+#include "def.h"
+#include "posterior_predictive_check.h"
+
+// [[Rcpp::export]]
+Rcpp::List ppc_mutual_information_cpp(const Rcpp::DataFrame& state,
+                                      std::size_t n_topics,
+                                      std::size_t n_types,
+                                      double beta,
+                                      std::size_t n_replications,
+                                      std::size_t n_threads,
+                                      double seed) {
+  IntVector docs = Rcpp::as<IntVector>(state["doc"]);
+  IntVector types = Rcpp::as<IntVector>(state["type"]);
+  IntVector topics = Rcpp::as<IntVector>(state["topic"]);
+
+  PosteriorPredictiveCheck ppc{n_topics, n_types, beta};
+  PosteriorPredictiveCheck::Result result = ppc.mutual_information(docs,
+                                                                   types,
+                                                                   topics,
+                                                                   n_replications,
+                                                                   n_threads,
+                                                                   static_cast<std::uint64_t>(seed));
+
+  Rcpp::NumericMatrix replicated(n_topics, n_replications);
+  for (std::size_t topic = 0; topic < n_topics; ++topic) {
+    for (std::size_t r = 0; r < n_replications; ++r) {
+      replicated(topic, r) = result.replicated.at(topic).at(r);
+    }
+  }
+
+  return Rcpp::List::create(Rcpp::Named("realized") = result.realized,
+                            Rcpp::Named("replicated") = replicated);
+}
@@ -0,0 +1,66 @@
+#include <Rcpp.h>
+#include <memory>
+#include <vector>
+
+#include "def.h"
+#include "R_utils.h"
+#include "left_to_right_evaluator.h"
+#include "racing_evaluator.h"
+#include "type_mapping.h"
+
+// [[Rcpp::export]]
+Rcpp::List race_left_to_right_cpp(SEXP corpus,
+                                  const Rcpp::List& models,
+                                  std::size_t n_particles,
+                                  bool resampling,
+                                  double confidence,
+                                  std::size_t min_docs,
+                                  double seed) {
+  std::size_t n_models = models.size();
+
+  // An encoded corpus is shared by all models and translated to the types of
+  // each while evaluating, a tokenized corpus is encoded for every model.
+  bool encoded = TYPEOF(corpus) == EXTPTRSXP;
+  std::unique_ptr<TypeSequenceView> encoded_corpus;
+  if (encoded) encoded_corpus.reset(new TypeSequenceView{create_type_sequence_view_from_R(corpus)});
+
+  std::vector<std::unique_ptr<LeftToRightEvaluator>> evaluators;
+  std::vector<TypeSequenceContainer> corpora;
+  corpora.reserve(n_models);
+
+  RacingEvaluator racer{confidence, min_docs};
+  racer.set_seed(static_cast<std::uint64_t>(seed));
+
+  for (std::size_t i = 0; i < n_models; ++i) {
+    Rcpp::List model = models[i];
+
+    std::size_t n_topics = Rcpp::as<std::size_t>(model["n_topics"]);
+    Alphabet alphabet = create_alphabet_from_R(model["alphabet"]);
+    std::size_t n_types = alphabet.size();
+
+    CountVector topic_counts = create_topic_counts_from_R(model["topic_counts"], n_topics);
+    IntMatrix type_topic_counts = create_type_topic_counts_from_R(model["type_topic_counts"],
+                                                                  n_types,
+                                                                  n_topics);
+    DoubleVector alpha = Rcpp::as<DoubleVector>(model["alpha"]);
+    double beta = Rcpp::as<double>(model["beta"]);
+
+    evaluators.emplace_back(new LeftToRightEvaluator{n_topics, alpha, beta,
+                                                     topic_counts, type_topic_counts});
+
+    if (encoded) {
+      evaluators.back()->set_type_mapping(TypeMapping{encoded_corpus->alphabet(), alphabet});
+      racer.add(*evaluators.back(), *encoded_corpus);
+    } else {
+      corpora.push_back(create_type_sequences_from_R(Rcpp::List(corpus), alphabet));
+      racer.add(*evaluators.back(), corpora.back());
+    }
+  }
+
+  RacingEvaluator::Result result = racer.race(n_particles, resampling);
+
+  return Rcpp::List::create(Rcpp::Named("winner") = result.winner + 1,
+                            Rcpp::Named("decided") = result.decided,
+                            Rcpp::Named("n_docs") = result.n_docs,
+                            Rcpp::Named("log_likelihood") = result.log_likelihood);
+}
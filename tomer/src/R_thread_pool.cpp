@@ -0,0 +1,25 @@
+#include <Rcpp.h>
+
+#include "thread_pool.h"
+
+// [[Rcpp::export]]
+void configure_thread_pool_cpp(std::size_t size,
+                               const std::vector<int>& cpus,
+                               const std::string& name) {
+  ThreadPool::get().configure(size, cpus, name);
+}
+
+// [[Rcpp::export]]
+Rcpp::List thread_pool_info_cpp() {
+  const ThreadPool& pool = ThreadPool::get();
+
+  return Rcpp::List::create(Rcpp::Named("size") = pool.size(),
+                            Rcpp::Named("cpus") = pool.cpus(),
+                            Rcpp::Named("name") = pool.name(),
+                            Rcpp::Named("running") = pool.running());
+}
+
+// [[Rcpp::export]]
+void shutdown_thread_pool_cpp() {
+  ThreadPool::get().shutdown();
+}
@@ -0,0 +1,158 @@
+#include <Rcpp.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "def.h"
+#include "alphabet.h"
+#include "corpus_statistics.h"
+#include "R_altrep.h"
+#include "R_utils.h"
+#include "type_mapping.h"
+#include "type_sequence_builder.h"
+#include "type_sequence_container.h"
+#include "type_sequence_view.h"
+
+// [[Rcpp::export]]
+SEXP encode_corpus_cpp(const Rcpp::List& corpus, SEXP alphabet) {
+  std::unique_ptr<TypeSequenceBuilder> builder;
+
+  if (Rf_isNull(alphabet))
+    builder.reset(new TypeSequenceBuilder{});
+  else
+    builder.reset(new TypeSequenceBuilder{create_alphabet_from_R(alphabet), true});
+
+  for (R_xlen_t i = 0; i < corpus.size(); ++i) {
+    add_corpus_from_R(*builder, Rcpp::as<Rcpp::DataFrame>(corpus[i]));
+  }
+
+  return wrap_type_sequence_container(builder->get_data());
+}
+
+// [[Rcpp::export]]
+Rcpp::DataFrame corpus_alphabet_cpp(SEXP corpus) {
+  Rcpp::XPtr<TypeSequenceContainer> types = unwrap_type_sequence_container(corpus);
+
+  std::vector<double> type;
+  for (auto const& entry : types->alphabet()) type.push_back(entry.first);
+
+  return Rcpp::DataFrame::create(Rcpp::Named("type") = type,
+                                 Rcpp::Named("token") = create_altrep_tokens(types->shared_alphabet()),
+                                 Rcpp::Named("stringsAsFactors") = false);
+}
+
+// [[Rcpp::export]]
+Rcpp::List corpus_types_cpp(SEXP corpus) {
+  return Rcpp::List::create(Rcpp::Named("types") = create_altrep_types(corpus),
+                            Rcpp::Named("offsets") = create_altrep_offsets(corpus));
+}
+
+// [[Rcpp::export]]
+Rcpp::DataFrame vocabulary_mapping_cpp(SEXP corpus, const Rcpp::DataFrame& alphabet) {
+  TypeSequenceView types = create_type_sequence_view_from_R(corpus);
+  TypeMapping mapping{types.alphabet(), create_alphabet_from_R(alphabet)};
+
+  std::vector<double> type, model_type;
+  for (auto const& entry : types.alphabet()) {
+    type.push_back(entry.first);
+    model_type.push_back(mapping.has(entry.first) ? mapping.at(entry.first) : NA_REAL);
+  }
+
+  return Rcpp::DataFrame::create(Rcpp::Named("type") = type,
+                                 Rcpp::Named("model_type") = model_type);
+}
+
+// [[Rcpp::export]]
+Rcpp::List corpus_size_cpp(SEXP corpus) {
+  TypeSequenceView types = create_type_sequence_view_from_R(corpus);
+
+  return Rcpp::List::create(Rcpp::Named("n_docs") = static_cast<double>(types.size()),
+                            Rcpp::Named("n_tokens") = static_cast<double>(types.n_tokens()));
+}
+
+// [[Rcpp::export]]
+SEXP subset_corpus_cpp(SEXP corpus, const std::vector<std::size_t>& documents) {
+  return wrap_type_sequence_view(create_type_sequence_view_from_R(corpus).subset(documents), corpus);
+}
+
+// [[Rcpp::export]]
+SEXP shard_corpus_cpp(SEXP corpus, std::size_t begin, std::size_t end) {
+  return wrap_type_sequence_view(create_type_sequence_view_from_R(corpus).shard(begin, end), corpus);
+}
+
+// [[Rcpp::export]]
+SEXP slice_documents_cpp(SEXP corpus, double from, double to) {
+  return wrap_type_sequence_view(create_type_sequence_view_from_R(corpus).token_range(from, to), corpus);
+}
+
+// [[Rcpp::export]]
+Rcpp::DataFrame prune_vocabulary_cpp(SEXP corpus,
+                                     double min_count,
+                                     double max_count,
+                                     const std::vector<std::string>& stopwords,
+                                     std::size_t n_threads) {
+  Rcpp::XPtr<TypeSequenceContainer> types = unwrap_type_sequence_container(corpus);
+
+  CountVector frequencies = types->type_frequencies(n_threads);
+  std::vector<bool> keep(frequencies.size());
+
+  for (std::size_t type = 0; type < frequencies.size(); ++type) {
+    keep[type] = frequencies[type] >= min_count && frequencies[type] <= max_count;
+  }
+
+  const Alphabet& alphabet = types->alphabet();
+  for (auto const& token : stopwords) {
+    if (alphabet.has(token)) keep.at(alphabet.at(token)) = false;
+  }
+
+  TypeMapping mapping{keep};
+  types->remap(mapping, n_threads);
+
+  std::vector<double> old_type, new_type;
+  for (std::size_t type = 0; type < mapping.size(); ++type) {
+    if (!mapping.has(type)) continue;
+    old_type.push_back(type);
+    new_type.push_back(mapping.at(type));
+  }
+
+  return Rcpp::DataFrame::create(Rcpp::Named("type") = old_type,
+                                 Rcpp::Named("new_type") = new_type);
+}
+
+// [[Rcpp::export]]
+Rcpp::List corpus_statistics_cpp(SEXP corpus, SEXP alphabet, std::size_t n_threads) {
+  TypeSequenceView types = create_type_sequence_view_from_R(corpus);
+
+  std::vector<bool> in_model;
+  if (!Rf_isNull(alphabet)) {
+    TypeMapping mapping{types.alphabet(), create_alphabet_from_R(alphabet)};
+
+    in_model.resize(mapping.size());
+    for (std::size_t type = 0; type < mapping.size(); ++type) in_model[type] = mapping.has(type);
+  }
+
+  CorpusStatistics statistics = CorpusStatistics::compute(types, in_model, n_threads);
+
+  std::vector<double> type, term_frequency, document_frequency;
+  for (std::size_t t = 0; t < statistics.term_frequencies.size(); ++t) {
+    if (statistics.term_frequencies[t] == 0) continue;
+
+    type.push_back(t);
+    term_frequency.push_back(statistics.term_frequencies[t]);
+    document_frequency.push_back(statistics.document_frequencies[t]);
+  }
+
+  Rcpp::DataFrame type_statistics = Rcpp::DataFrame::create(
+    Rcpp::Named("type") = type,
+    Rcpp::Named("term_frequency") = term_frequency,
+    Rcpp::Named("document_frequency") = document_frequency);
+
+  return Rcpp::List::create(
+    Rcpp::Named("types") = type_statistics,
+    Rcpp::Named("document_lengths") = Rcpp::NumericVector(statistics.document_lengths.cbegin(),
+                                                          statistics.document_lengths.cend()),
+    Rcpp::Named("vocabulary_growth") = Rcpp::NumericVector(statistics.vocabulary_growth.cbegin(),
+                                                           statistics.vocabulary_growth.cend()),
+    Rcpp::Named("n_tokens") = static_cast<double>(statistics.n_tokens),
+    Rcpp::Named("n_oov_tokens") = in_model.empty() ? NA_REAL : static_cast<double>(statistics.n_oov_tokens));
+}
@@ -0,0 +1,192 @@
+#include "R_utils.h"
+
+#include <cmath>
+#include <limits>
+#include <string>
+#include <unordered_map>
+
+namespace {
+
+const char* CORPUS_TAG = "tomer_corpus";
+const char* VIEW_TAG = "tomer_corpus_view";
+
+bool is_type_sequence_view(SEXP corpus) {
+  return TYPEOF(corpus) == EXTPTRSXP && R_ExternalPtrTag(corpus) == Rf_install(VIEW_TAG);
+}
+
+}
+
+// Adds the documents of one tokenized chunk to the builder. R interns
+// strings, so all occurrences of a token share one CHARSXP and every distinct
+// token is only converted and looked up once; after that rows are encoded by
+// pointer. Rows of a document need not be adjacent: documents are numbered in
+// order of their first row and grouped by the builder. Ids are read as
+// doubles, which represents ids beyond 2^31 exactly.
+void add_corpus_from_R(TypeSequenceBuilder& builder,
+                       const Rcpp::DataFrame& corpus) {
+  Rcpp::NumericVector doc_id = corpus["id"];
+  SEXP doc_token = corpus["token"];
+
+  if (TYPEOF(doc_token) != STRSXP)
+    Rcpp::stop("tokens must be a character vector");
+
+  R_xlen_t n_tokens = doc_id.size();
+  if (n_tokens == 0) return;
+
+  const TypeSequenceBuilder::CompactType UNKNOWN =
+    std::numeric_limits<TypeSequenceBuilder::CompactType>::max();
+
+  std::unordered_map<SEXP, TypeSequenceBuilder::CompactType> types_by_token;
+  std::unordered_map<double, std::size_t> documents_by_id;
+
+  TypeSequenceBuilder::TypeVector types;
+  TypeSequenceBuilder::DocumentVector documents;
+  types.reserve(n_tokens);
+  documents.reserve(n_tokens);
+
+  std::size_t document = 0;
+
+  for (R_xlen_t i = 0; i < n_tokens; ++i) {
+    if (i == 0 || doc_id[i] != doc_id[i - 1]) {
+      // NaN never equals itself, so every such token would become a
+      // document of its own.
+      double id = doc_id[i];
+      if (std::isnan(id))
+        Rcpp::stop("document ids must not be NA or NaN");
+
+      auto p = documents_by_id.insert(std::make_pair(id, documents_by_id.size()));
+      document = p.first->second;
+    }
+
+    SEXP token = STRING_ELT(doc_token, i);
+    auto t = types_by_token.find(token);
+
+    if (t == types_by_token.end()) {
+      TypeSequenceBuilder::CompactType type;
+      if (!builder.encode(std::string(CHAR(token), LENGTH(token)), type)) type = UNKNOWN;
+      t = types_by_token.insert(std::make_pair(token, type)).first;
+    }
+
+    if (t->second == UNKNOWN) continue;
+
+    types.push_back(t->second);
+    documents.push_back(document);
+  }
+
+  builder.add(types, documents, documents_by_id.size(), 0);
+}
+
+Alphabet create_alphabet_from_R(const Rcpp::DataFrame& alphabet) {
+  std::map<Alphabet::Token, Alphabet::Type> a{};
+
+  DoubleVector types = Rcpp::as<DoubleVector>(alphabet["type"]);
+  StringVector tokens = Rcpp::as<StringVector>(alphabet["token"]);
+
+  std::size_t type;
+  std::string token;
+
+  for (std::size_t i = 0; i < types.size(); ++i) {
+    type = types.at(i);
+    token = tokens.at(i);
+
+    a.insert(std::make_pair(token, type));
+  }
+
+  return Alphabet{a};
+}
+
+CountVector create_topic_counts_from_R(const Rcpp::DataFrame& topic_counts,
+                                       std::size_t n_topics) {
+  IntVector topics = Rcpp::as<IntVector>(topic_counts["topic"]);
+  DoubleVector counts = Rcpp::as<DoubleVector>(topic_counts["count"]);
+  CountVector tc(n_topics);
+
+  std::size_t topic;
+  Count count;
+
+  for (std::size_t i = 0; i < topics.size(); ++i) {
+    topic = topics.at(i);
+    count = counts.at(i);
+    tc.at(topic) = count;
+  }
+
+  return tc;
+}
+
+IntMatrix create_type_topic_counts_from_R(const Rcpp::DataFrame& type_topic_counts,
+                                          std::size_t n_types,
+                                          std::size_t n_topics) {
+  IntMatrix ttc(n_types);
+
+  for (std::size_t i = 0; i < n_types; ++i) {
+    ttc.at(i) = IntVector(n_topics, 0);
+  }
+
+  DoubleVector types = Rcpp::as<DoubleVector>(type_topic_counts["type"]);
+  IntVector topics = Rcpp::as<IntVector>(type_topic_counts["topic"]);
+  IntVector counts = Rcpp::as<IntVector>(type_topic_counts["count"]);
+
+  std::size_t type, topic, count;
+
+  for (std::size_t i = 0; i < types.size(); ++i) {
+    type = types.at(i);
+    topic = topics.at(i);
+    count = counts.at(i);
+
+    ttc.at(type).at(topic) = count;
+  }
+
+  return ttc;
+}
+
+// The corpus is given as a list of tokenized chunks. A document must not be
+// split across chunks.
+TypeSequenceContainer create_type_sequences_from_R(const Rcpp::List& corpus,
+                                                   const Alphabet& alphabet) {
+  TypeSequenceBuilder builder{alphabet, true};
+
+  for (R_xlen_t i = 0; i < corpus.size(); ++i) {
+    add_corpus_from_R(builder, Rcpp::as<Rcpp::DataFrame>(corpus[i]));
+  }
+
+  return builder.get_data();
+}
+
+SEXP wrap_type_sequence_container(TypeSequenceContainer container) {
+  return wrap_external_pointer(new TypeSequenceContainer{std::move(container)}, CORPUS_TAG);
+}
+
+Rcpp::XPtr<TypeSequenceContainer> unwrap_type_sequence_container(SEXP corpus) {
+  if (is_type_sequence_view(corpus))
+    Rcpp::stop("expected a whole encoded corpus, not a view of one");
+
+  return unwrap_external_pointer<TypeSequenceContainer>(corpus, CORPUS_TAG, "an encoded corpus");
+}
+
+TypeSequenceView create_type_sequence_view_from_R(SEXP corpus) {
+  if (!is_type_sequence_view(corpus))
+    return TypeSequenceView{*unwrap_type_sequence_container(corpus)};
+
+  Rcpp::XPtr<TypeSequenceView> view = unwrap_external_pointer<TypeSequenceView>(corpus, VIEW_TAG,
+                                                                                "an encoded corpus");
+  if (view->is_stale())
+    Rcpp::stop("the corpus has been pruned since the view was made");
+
+  return *view;
+}
+
+SEXP wrap_type_sequence_view(TypeSequenceView&& view, SEXP corpus) {
+  SEXP container = is_type_sequence_view(corpus) ? R_ExternalPtrProtected(corpus) : corpus;
+
+  Rcpp::XPtr<TypeSequenceView> ptr(new TypeSequenceView{std::move(view)}, true,
+                                   Rf_install(VIEW_TAG), container);
+  return ptr;
+}
+
+NumaPlacement create_numa_placement_from_R(const std::string& placement) {
+  if (placement == "none") return NumaPlacement::NONE;
+  if (placement == "replicate") return NumaPlacement::REPLICATE;
+  if (placement == "interleave") return NumaPlacement::INTERLEAVE;
+
+  Rcpp::stop("unknown NUMA placement '" + placement + "'");
+}
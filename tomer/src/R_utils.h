@@ -0,0 +1,67 @@
+#ifndef R_UTILS_H
+#define R_UTILS_H
+
+#include <Rcpp.h>
+
+#include <string>
+
+#include "def.h"
+#include "alphabet.h"
+#include "numa.h"
+#include "type_sequence_builder.h"
+#include "type_sequence_container.h"
+#include "type_sequence_view.h"
+
+void add_corpus_from_R(TypeSequenceBuilder& builder,
+                       const Rcpp::DataFrame& corpus);
+
+Alphabet create_alphabet_from_R(const Rcpp::DataFrame& alphabet);
+
+CountVector create_topic_counts_from_R(const Rcpp::DataFrame& topic_counts,
+                                       std::size_t n_topics);
+
+IntMatrix create_type_topic_counts_from_R(const Rcpp::DataFrame& type_topic_counts,
+                                          std::size_t n_types,
+                                          std::size_t n_topics);
+
+TypeSequenceContainer create_type_sequences_from_R(const Rcpp::List& corpus,
+                                                   const Alphabet& alphabet);
+
+// Wraps an object for R in an external pointer tagged with the name of its
+// class, so that unwrap_external_pointer can tell it from any other pointer.
+template <typename T>
+SEXP wrap_external_pointer(T* object, const char* tag) {
+  Rcpp::XPtr<T> ptr(object, true, Rf_install(tag), R_NilValue);
+  return ptr;
+}
+
+// The object behind an external pointer wrapped with the same tag. Any other
+// object, and a pointer that did not survive saving the session, is an error
+// naming the expected object.
+template <typename T>
+Rcpp::XPtr<T> unwrap_external_pointer(SEXP x, const char* tag, const char* what) {
+  if (TYPEOF(x) != EXTPTRSXP || R_ExternalPtrTag(x) != Rf_install(tag))
+    Rcpp::stop(std::string{"expected "} + what);
+
+  if (R_ExternalPtrAddr(x) == nullptr)
+    Rcpp::stop(std::string{what} + " is no longer valid; it cannot be saved with the session");
+
+  return Rcpp::XPtr<T>(x);
+}
+
+SEXP wrap_type_sequence_container(TypeSequenceContainer container);
+
+// The container of an encoded corpus, not a view of one.
+Rcpp::XPtr<TypeSequenceContainer> unwrap_type_sequence_container(SEXP corpus);
+
+// An encoded corpus is the external pointer of either a TypeSequenceContainer
+// or a TypeSequenceView made from one.
+TypeSequenceView create_type_sequence_view_from_R(SEXP corpus);
+
+// The external pointer of a view made from the encoded corpus, which keeps
+// the container the view selects from alive.
+SEXP wrap_type_sequence_view(TypeSequenceView&& view, SEXP corpus);
+
+NumaPlacement create_numa_placement_from_R(const std::string& placement);
+
+#endif // R_UTILS_H
@@ -0,0 +1,59 @@
+#include <Rcpp.h>
+#include <string>
+#include <vector>
+
+#include "R_utils.h"
+#include "word_vectors.h"
+
+namespace {
+
+const char* VECTORS_TAG = "tomer_word_vectors";
+
+Rcpp::XPtr<WordVectors::SPtr> unwrap_word_vectors(SEXP vectors) {
+  return unwrap_external_pointer<WordVectors::SPtr>(vectors, VECTORS_TAG, "word vectors");
+}
+
+}
+
+// [[Rcpp::export]]
+void convert_word_vectors_cpp(const std::string& input, const std::string& output, const std::string& format) {
+  WordVectors::Format f;
+
+  if (format == "word2vec")
+    f = WordVectors::Format::WORD2VEC;
+  else if (format == "text")
+    f = WordVectors::Format::TEXT;
+  else
+    throw std::invalid_argument("unknown word vector format '" + format + "'");
+
+  WordVectors::convert(input, output, f);
+}
+
+// [[Rcpp::export]]
+SEXP open_word_vectors_cpp(const std::string& path) {
+  return wrap_external_pointer(new WordVectors::SPtr{WordVectors::open(path)}, VECTORS_TAG);
+}
+
+// [[Rcpp::export]]
+Rcpp::List word_vectors_info_cpp(SEXP vectors) {
+  Rcpp::XPtr<WordVectors::SPtr> ptr = unwrap_word_vectors(vectors);
+
+  return Rcpp::List::create(Rcpp::Named("n_words") = static_cast<double>((*ptr)->size()),
+                            Rcpp::Named("dimension") = static_cast<double>((*ptr)->dimension()));
+}
+
+// [[Rcpp::export]]
+Rcpp::NumericVector embedding_coherence_cpp(SEXP vectors, const Rcpp::List& topic_tokens, std::size_t n_threads) {
+  Rcpp::XPtr<WordVectors::SPtr> ptr = unwrap_word_vectors(vectors);
+  const WordVectors& word_vectors = **ptr;
+
+  std::vector<std::vector<std::int64_t>> topic_rows(topic_tokens.size());
+
+  for (R_xlen_t topic = 0; topic < topic_tokens.size(); ++topic) {
+    std::vector<std::string> tokens = Rcpp::as<std::vector<std::string>>(topic_tokens[topic]);
+    for (auto const& token : tokens) topic_rows[topic].push_back(word_vectors.find(token));
+  }
+
+  DoubleVector coherence = word_vectors.coherence(topic_rows, n_threads);
+  return Rcpp::NumericVector(coherence.begin(), coherence.end());
+}
@@ -5,14 +5,225 @@
 
 using namespace Rcpp;
 
-// evaluate_left_to_right_cpp
-double evaluate_left_to_right_cpp(const Rcpp::DataFrame& corpus, std::size_t n_docs, const Rcpp::DataFrame& alphabet, std::size_t n_topics, const Rcpp::DataFrame& topic_counts, const Rcpp::DataFrame& type_topic_counts, const Rcpp::NumericVector& alpha, double beta, std::size_t n_particles, bool resampling);
-RcppExport SEXP _tomer_evaluate_left_to_right_cpp(SEXP corpusSEXP, SEXP n_docsSEXP, SEXP alphabetSEXP, SEXP n_topicsSEXP, SEXP topic_countsSEXP, SEXP type_topic_countsSEXP, SEXP alphaSEXP, SEXP betaSEXP, SEXP n_particlesSEXP, SEXP resamplingSEXP) {
+// diff_checkpoints_cpp
+Rcpp::List diff_checkpoints_cpp(const Rcpp::DataFrame& alphabet_before, const Rcpp::DataFrame& type_topic_counts_before, const Rcpp::DataFrame& alphabet_after, const Rcpp::DataFrame& type_topic_counts_after, std::size_t n_topics, std::size_t n_top_types, std::size_t n_threads);
+RcppExport SEXP _tomer_diff_checkpoints_cpp(SEXP alphabet_beforeSEXP, SEXP type_topic_counts_beforeSEXP, SEXP alphabet_afterSEXP, SEXP type_topic_counts_afterSEXP, SEXP n_topicsSEXP, SEXP n_top_typesSEXP, SEXP n_threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const Rcpp::DataFrame& >::type alphabet_before(alphabet_beforeSEXP);
+    Rcpp::traits::input_parameter< const Rcpp::DataFrame& >::type type_topic_counts_before(type_topic_counts_beforeSEXP);
+    Rcpp::traits::input_parameter< const Rcpp::DataFrame& >::type alphabet_after(alphabet_afterSEXP);
+    Rcpp::traits::input_parameter< const Rcpp::DataFrame& >::type type_topic_counts_after(type_topic_counts_afterSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type n_topics(n_topicsSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type n_top_types(n_top_typesSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type n_threads(n_threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(diff_checkpoints_cpp(alphabet_before, type_topic_counts_before, alphabet_after, type_topic_counts_after, n_topics, n_top_types, n_threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// sample_corpus_cpp
+SEXP sample_corpus_cpp(const Rcpp::DataFrame& alphabet, std::size_t n_topics, const Rcpp::DataFrame& type_topic_counts, const Rcpp::NumericVector& alpha, double beta, const Rcpp::NumericVector& lengths, std::size_t n_threads, double seed);
+RcppExport SEXP _tomer_sample_corpus_cpp(SEXP alphabetSEXP, SEXP n_topicsSEXP, SEXP type_topic_countsSEXP, SEXP alphaSEXP, SEXP betaSEXP, SEXP lengthsSEXP, SEXP n_threadsSEXP, SEXP seedSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const Rcpp::DataFrame& >::type alphabet(alphabetSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type n_topics(n_topicsSEXP);
+    Rcpp::traits::input_parameter< const Rcpp::DataFrame& >::type type_topic_counts(type_topic_countsSEXP);
+    Rcpp::traits::input_parameter< const Rcpp::NumericVector& >::type alpha(alphaSEXP);
+    Rcpp::traits::input_parameter< double >::type beta(betaSEXP);
+    Rcpp::traits::input_parameter< const Rcpp::NumericVector& >::type lengths(lengthsSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type n_threads(n_threadsSEXP);
+    Rcpp::traits::input_parameter< double >::type seed(seedSEXP);
+    rcpp_result_gen = Rcpp::wrap(sample_corpus_cpp(alphabet, n_topics, type_topic_counts, alpha, beta, lengths, n_threads, seed));
+    return rcpp_result_gen;
+END_RCPP
+}
+// compress_alphabet_cpp
+SEXP compress_alphabet_cpp(const Rcpp::DataFrame& alphabet, std::size_t block_size, bool hash);
+RcppExport SEXP _tomer_compress_alphabet_cpp(SEXP alphabetSEXP, SEXP block_sizeSEXP, SEXP hashSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const Rcpp::DataFrame& >::type alphabet(alphabetSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type block_size(block_sizeSEXP);
+    Rcpp::traits::input_parameter< bool >::type hash(hashSEXP);
+    rcpp_result_gen = Rcpp::wrap(compress_alphabet_cpp(alphabet, block_size, hash));
+    return rcpp_result_gen;
+END_RCPP
+}
+// open_dictionary_cpp
+SEXP open_dictionary_cpp(const std::string& path);
+RcppExport SEXP _tomer_open_dictionary_cpp(SEXP pathSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const std::string& >::type path(pathSEXP);
+    rcpp_result_gen = Rcpp::wrap(open_dictionary_cpp(path));
+    return rcpp_result_gen;
+END_RCPP
+}
+// save_dictionary_cpp
+void save_dictionary_cpp(SEXP dictionary, const std::string& path);
+RcppExport SEXP _tomer_save_dictionary_cpp(SEXP dictionarySEXP, SEXP pathSEXP) {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type dictionary(dictionarySEXP);
+    Rcpp::traits::input_parameter< const std::string& >::type path(pathSEXP);
+    save_dictionary_cpp(dictionary, path);
+    return R_NilValue;
+END_RCPP
+}
+// dictionary_types_cpp
+Rcpp::NumericVector dictionary_types_cpp(SEXP dictionary, const std::vector<std::string>& tokens);
+RcppExport SEXP _tomer_dictionary_types_cpp(SEXP dictionarySEXP, SEXP tokensSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type dictionary(dictionarySEXP);
+    Rcpp::traits::input_parameter< const std::vector<std::string>& >::type tokens(tokensSEXP);
+    rcpp_result_gen = Rcpp::wrap(dictionary_types_cpp(dictionary, tokens));
+    return rcpp_result_gen;
+END_RCPP
+}
+// dictionary_tokens_cpp
+Rcpp::CharacterVector dictionary_tokens_cpp(SEXP dictionary, const std::vector<double>& types);
+RcppExport SEXP _tomer_dictionary_tokens_cpp(SEXP dictionarySEXP, SEXP typesSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type dictionary(dictionarySEXP);
+    Rcpp::traits::input_parameter< const std::vector<double>& >::type types(typesSEXP);
+    rcpp_result_gen = Rcpp::wrap(dictionary_tokens_cpp(dictionary, types));
+    return rcpp_result_gen;
+END_RCPP
+}
+// dictionary_info_cpp
+Rcpp::List dictionary_info_cpp(SEXP dictionary);
+RcppExport SEXP _tomer_dictionary_info_cpp(SEXP dictionarySEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type dictionary(dictionarySEXP);
+    rcpp_result_gen = Rcpp::wrap(dictionary_info_cpp(dictionary));
+    return rcpp_result_gen;
+END_RCPP
+}
+// optimize_hyperparameters_cpp
+Rcpp::List optimize_hyperparameters_cpp(const Rcpp::DataFrame& state, const Rcpp::DataFrame& type_topic_counts, std::size_t n_topics, std::size_t n_types, std::size_t n_docs, const Rcpp::NumericVector& alpha, double beta, std::size_t n_iterations, double shape, double scale);
+RcppExport SEXP _tomer_optimize_hyperparameters_cpp(SEXP stateSEXP, SEXP type_topic_countsSEXP, SEXP n_topicsSEXP, SEXP n_typesSEXP, SEXP n_docsSEXP, SEXP alphaSEXP, SEXP betaSEXP, SEXP n_iterationsSEXP, SEXP shapeSEXP, SEXP scaleSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const Rcpp::DataFrame& >::type state(stateSEXP);
+    Rcpp::traits::input_parameter< const Rcpp::DataFrame& >::type type_topic_counts(type_topic_countsSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type n_topics(n_topicsSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type n_types(n_typesSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type n_docs(n_docsSEXP);
+    Rcpp::traits::input_parameter< const Rcpp::NumericVector& >::type alpha(alphaSEXP);
+    Rcpp::traits::input_parameter< double >::type beta(betaSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type n_iterations(n_iterationsSEXP);
+    Rcpp::traits::input_parameter< double >::type shape(shapeSEXP);
+    Rcpp::traits::input_parameter< double >::type scale(scaleSEXP);
+    rcpp_result_gen = Rcpp::wrap(optimize_hyperparameters_cpp(state, type_topic_counts, n_topics, n_types, n_docs, alpha, beta, n_iterations, shape, scale));
+    return rcpp_result_gen;
+END_RCPP
+}
+// evaluate_importance_sampling_cpp
+Rcpp::NumericVector evaluate_importance_sampling_cpp(SEXP corpus, const Rcpp::DataFrame& alphabet, std::size_t n_topics, const Rcpp::DataFrame& topic_counts, const Rcpp::DataFrame& type_topic_counts, const Rcpp::NumericVector& alpha, double beta, std::size_t n_samples, std::size_t n_threads, double seed);
+RcppExport SEXP _tomer_evaluate_importance_sampling_cpp(SEXP corpusSEXP, SEXP alphabetSEXP, SEXP n_topicsSEXP, SEXP topic_countsSEXP, SEXP type_topic_countsSEXP, SEXP alphaSEXP, SEXP betaSEXP, SEXP n_samplesSEXP, SEXP n_threadsSEXP, SEXP seedSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type corpus(corpusSEXP);
+    Rcpp::traits::input_parameter< const Rcpp::DataFrame& >::type alphabet(alphabetSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type n_topics(n_topicsSEXP);
+    Rcpp::traits::input_parameter< const Rcpp::DataFrame& >::type topic_counts(topic_countsSEXP);
+    Rcpp::traits::input_parameter< const Rcpp::DataFrame& >::type type_topic_counts(type_topic_countsSEXP);
+    Rcpp::traits::input_parameter< const Rcpp::NumericVector& >::type alpha(alphaSEXP);
+    Rcpp::traits::input_parameter< double >::type beta(betaSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type n_samples(n_samplesSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type n_threads(n_threadsSEXP);
+    Rcpp::traits::input_parameter< double >::type seed(seedSEXP);
+    rcpp_result_gen = Rcpp::wrap(evaluate_importance_sampling_cpp(corpus, alphabet, n_topics, topic_counts, type_topic_counts, alpha, beta, n_samples, n_threads, seed));
+    return rcpp_result_gen;
+END_RCPP
+}
+// build_reference_index_cpp
+void build_reference_index_cpp(SEXP corpus, const std::string& path, std::size_t n_threads);
+RcppExport SEXP _tomer_build_reference_index_cpp(SEXP corpusSEXP, SEXP pathSEXP, SEXP n_threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type corpus(corpusSEXP);
+    Rcpp::traits::input_parameter< const std::string& >::type path(pathSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type n_threads(n_threadsSEXP);
+    build_reference_index_cpp(corpus, path, n_threads);
+    return R_NilValue;
+END_RCPP
+}
+// open_reference_index_cpp
+SEXP open_reference_index_cpp(const std::string& path);
+RcppExport SEXP _tomer_open_reference_index_cpp(SEXP pathSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
-    Rcpp::traits::input_parameter< const Rcpp::DataFrame& >::type corpus(corpusSEXP);
+    Rcpp::traits::input_parameter< const std::string& >::type path(pathSEXP);
+    rcpp_result_gen = Rcpp::wrap(open_reference_index_cpp(path));
+    return rcpp_result_gen;
+END_RCPP
+}
+// co_document_frequencies_cpp
+Rcpp::DataFrame co_document_frequencies_cpp(SEXP index, const std::vector<std::string>& first, const std::vector<std::string>& second, std::size_t n_threads);
+RcppExport SEXP _tomer_co_document_frequencies_cpp(SEXP indexSEXP, SEXP firstSEXP, SEXP secondSEXP, SEXP n_threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type index(indexSEXP);
+    Rcpp::traits::input_parameter< const std::vector<std::string>& >::type first(firstSEXP);
+    Rcpp::traits::input_parameter< const std::vector<std::string>& >::type second(secondSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type n_threads(n_threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(co_document_frequencies_cpp(index, first, second, n_threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// reference_index_documents_cpp
+double reference_index_documents_cpp(SEXP index);
+RcppExport SEXP _tomer_reference_index_documents_cpp(SEXP indexSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type index(indexSEXP);
+    rcpp_result_gen = Rcpp::wrap(reference_index_documents_cpp(index));
+    return rcpp_result_gen;
+END_RCPP
+}
+// joint_log_likelihood_cpp
+Rcpp::List joint_log_likelihood_cpp(const Rcpp::DataFrame& state, const Rcpp::DataFrame& topic_counts, const Rcpp::DataFrame& type_topic_counts, std::size_t n_topics, std::size_t n_types, std::size_t n_docs, const Rcpp::NumericVector& alpha, double beta, std::size_t n_threads);
+RcppExport SEXP _tomer_joint_log_likelihood_cpp(SEXP stateSEXP, SEXP topic_countsSEXP, SEXP type_topic_countsSEXP, SEXP n_topicsSEXP, SEXP n_typesSEXP, SEXP n_docsSEXP, SEXP alphaSEXP, SEXP betaSEXP, SEXP n_threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const Rcpp::DataFrame& >::type state(stateSEXP);
+    Rcpp::traits::input_parameter< const Rcpp::DataFrame& >::type topic_counts(topic_countsSEXP);
+    Rcpp::traits::input_parameter< const Rcpp::DataFrame& >::type type_topic_counts(type_topic_countsSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type n_topics(n_topicsSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type n_types(n_typesSEXP);
     Rcpp::traits::input_parameter< std::size_t >::type n_docs(n_docsSEXP);
+    Rcpp::traits::input_parameter< const Rcpp::NumericVector& >::type alpha(alphaSEXP);
+    Rcpp::traits::input_parameter< double >::type beta(betaSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type n_threads(n_threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(joint_log_likelihood_cpp(state, topic_counts, type_topic_counts, n_topics, n_types, n_docs, alpha, beta, n_threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// evaluate_left_to_right_cpp
+Rcpp::NumericVector evaluate_left_to_right_cpp(const Rcpp::List& corpus, const Rcpp::DataFrame& alphabet, std::size_t n_topics, const Rcpp::DataFrame& topic_counts, const Rcpp::DataFrame& type_topic_counts, const Rcpp::NumericVector& alpha, double beta, std::size_t n_particles, bool resampling, std::size_t n_threads, const std::string& numa, std::size_t n_lanes, double seed);
+RcppExport SEXP _tomer_evaluate_left_to_right_cpp(SEXP corpusSEXP, SEXP alphabetSEXP, SEXP n_topicsSEXP, SEXP topic_countsSEXP, SEXP type_topic_countsSEXP, SEXP alphaSEXP, SEXP betaSEXP, SEXP n_particlesSEXP, SEXP resamplingSEXP, SEXP n_threadsSEXP, SEXP numaSEXP, SEXP n_lanesSEXP, SEXP seedSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const Rcpp::List& >::type corpus(corpusSEXP);
     Rcpp::traits::input_parameter< const Rcpp::DataFrame& >::type alphabet(alphabetSEXP);
     Rcpp::traits::input_parameter< std::size_t >::type n_topics(n_topicsSEXP);
     Rcpp::traits::input_parameter< const Rcpp::DataFrame& >::type topic_counts(topic_countsSEXP);
@@ -21,17 +232,469 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< double >::type beta(betaSEXP);
     Rcpp::traits::input_parameter< std::size_t >::type n_particles(n_particlesSEXP);
     Rcpp::traits::input_parameter< bool >::type resampling(resamplingSEXP);
-    rcpp_result_gen = Rcpp::wrap(evaluate_left_to_right_cpp(corpus, n_docs, alphabet, n_topics, topic_counts, type_topic_counts, alpha, beta, n_particles, resampling));
+    Rcpp::traits::input_parameter< std::size_t >::type n_threads(n_threadsSEXP);
+    Rcpp::traits::input_parameter< const std::string& >::type numa(numaSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type n_lanes(n_lanesSEXP);
+    Rcpp::traits::input_parameter< double >::type seed(seedSEXP);
+    rcpp_result_gen = Rcpp::wrap(evaluate_left_to_right_cpp(corpus, alphabet, n_topics, topic_counts, type_topic_counts, alpha, beta, n_particles, resampling, n_threads, numa, n_lanes, seed));
+    return rcpp_result_gen;
+END_RCPP
+}
+// evaluate_left_to_right_encoded_cpp
+Rcpp::NumericVector evaluate_left_to_right_encoded_cpp(SEXP corpus, const Rcpp::DataFrame& alphabet, std::size_t n_topics, const Rcpp::DataFrame& topic_counts, const Rcpp::DataFrame& type_topic_counts, const Rcpp::NumericVector& alpha, double beta, std::size_t n_particles, bool resampling, std::size_t n_threads, const std::string& numa, std::size_t n_lanes, double seed);
+RcppExport SEXP _tomer_evaluate_left_to_right_encoded_cpp(SEXP corpusSEXP, SEXP alphabetSEXP, SEXP n_topicsSEXP, SEXP topic_countsSEXP, SEXP type_topic_countsSEXP, SEXP alphaSEXP, SEXP betaSEXP, SEXP n_particlesSEXP, SEXP resamplingSEXP, SEXP n_threadsSEXP, SEXP numaSEXP, SEXP n_lanesSEXP, SEXP seedSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type corpus(corpusSEXP);
+    Rcpp::traits::input_parameter< const Rcpp::DataFrame& >::type alphabet(alphabetSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type n_topics(n_topicsSEXP);
+    Rcpp::traits::input_parameter< const Rcpp::DataFrame& >::type topic_counts(topic_countsSEXP);
+    Rcpp::traits::input_parameter< const Rcpp::DataFrame& >::type type_topic_counts(type_topic_countsSEXP);
+    Rcpp::traits::input_parameter< const Rcpp::NumericVector& >::type alpha(alphaSEXP);
+    Rcpp::traits::input_parameter< double >::type beta(betaSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type n_particles(n_particlesSEXP);
+    Rcpp::traits::input_parameter< bool >::type resampling(resamplingSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type n_threads(n_threadsSEXP);
+    Rcpp::traits::input_parameter< const std::string& >::type numa(numaSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type n_lanes(n_lanesSEXP);
+    Rcpp::traits::input_parameter< double >::type seed(seedSEXP);
+    rcpp_result_gen = Rcpp::wrap(evaluate_left_to_right_encoded_cpp(corpus, alphabet, n_topics, topic_counts, type_topic_counts, alpha, beta, n_particles, resampling, n_threads, numa, n_lanes, seed));
+    return rcpp_result_gen;
+END_RCPP
+}
+// evaluate_left_to_right_diagnostics_cpp
+Rcpp::List evaluate_left_to_right_diagnostics_cpp(const Rcpp::List& corpus, const Rcpp::DataFrame& alphabet, std::size_t n_topics, const Rcpp::DataFrame& topic_counts, const Rcpp::DataFrame& type_topic_counts, const Rcpp::NumericVector& alpha, double beta, std::size_t n_particles, bool resampling, std::size_t n_threads, double seed);
+RcppExport SEXP _tomer_evaluate_left_to_right_diagnostics_cpp(SEXP corpusSEXP, SEXP alphabetSEXP, SEXP n_topicsSEXP, SEXP topic_countsSEXP, SEXP type_topic_countsSEXP, SEXP alphaSEXP, SEXP betaSEXP, SEXP n_particlesSEXP, SEXP resamplingSEXP, SEXP n_threadsSEXP, SEXP seedSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const Rcpp::List& >::type corpus(corpusSEXP);
+    Rcpp::traits::input_parameter< const Rcpp::DataFrame& >::type alphabet(alphabetSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type n_topics(n_topicsSEXP);
+    Rcpp::traits::input_parameter< const Rcpp::DataFrame& >::type topic_counts(topic_countsSEXP);
+    Rcpp::traits::input_parameter< const Rcpp::DataFrame& >::type type_topic_counts(type_topic_countsSEXP);
+    Rcpp::traits::input_parameter< const Rcpp::NumericVector& >::type alpha(alphaSEXP);
+    Rcpp::traits::input_parameter< double >::type beta(betaSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type n_particles(n_particlesSEXP);
+    Rcpp::traits::input_parameter< bool >::type resampling(resamplingSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type n_threads(n_threadsSEXP);
+    Rcpp::traits::input_parameter< double >::type seed(seedSEXP);
+    rcpp_result_gen = Rcpp::wrap(evaluate_left_to_right_diagnostics_cpp(corpus, alphabet, n_topics, topic_counts, type_topic_counts, alpha, beta, n_particles, resampling, n_threads, seed));
+    return rcpp_result_gen;
+END_RCPP
+}
+// evaluate_left_to_right_anytime_cpp
+Rcpp::List evaluate_left_to_right_anytime_cpp(SEXP corpus, const Rcpp::DataFrame& alphabet, std::size_t n_topics, const Rcpp::DataFrame& topic_counts, const Rcpp::DataFrame& type_topic_counts, const Rcpp::NumericVector& alpha, double beta, std::size_t n_particles, bool resampling, double seconds, std::size_t n_threads, const std::string& numa, double seed);
+RcppExport SEXP _tomer_evaluate_left_to_right_anytime_cpp(SEXP corpusSEXP, SEXP alphabetSEXP, SEXP n_topicsSEXP, SEXP topic_countsSEXP, SEXP type_topic_countsSEXP, SEXP alphaSEXP, SEXP betaSEXP, SEXP n_particlesSEXP, SEXP resamplingSEXP, SEXP secondsSEXP, SEXP n_threadsSEXP, SEXP numaSEXP, SEXP seedSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type corpus(corpusSEXP);
+    Rcpp::traits::input_parameter< const Rcpp::DataFrame& >::type alphabet(alphabetSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type n_topics(n_topicsSEXP);
+    Rcpp::traits::input_parameter< const Rcpp::DataFrame& >::type topic_counts(topic_countsSEXP);
+    Rcpp::traits::input_parameter< const Rcpp::DataFrame& >::type type_topic_counts(type_topic_countsSEXP);
+    Rcpp::traits::input_parameter< const Rcpp::NumericVector& >::type alpha(alphaSEXP);
+    Rcpp::traits::input_parameter< double >::type beta(betaSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type n_particles(n_particlesSEXP);
+    Rcpp::traits::input_parameter< bool >::type resampling(resamplingSEXP);
+    Rcpp::traits::input_parameter< double >::type seconds(secondsSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type n_threads(n_threadsSEXP);
+    Rcpp::traits::input_parameter< const std::string& >::type numa(numaSEXP);
+    Rcpp::traits::input_parameter< double >::type seed(seedSEXP);
+    rcpp_result_gen = Rcpp::wrap(evaluate_left_to_right_anytime_cpp(corpus, alphabet, n_topics, topic_counts, type_topic_counts, alpha, beta, n_particles, resampling, seconds, n_threads, numa, seed));
+    return rcpp_result_gen;
+END_RCPP
+}
+// evaluate_left_to_right_resumable_cpp
+Rcpp::List evaluate_left_to_right_resumable_cpp(const Rcpp::List& corpus, const Rcpp::DataFrame& alphabet, std::size_t n_topics, const Rcpp::DataFrame& topic_counts, const Rcpp::DataFrame& type_topic_counts, const Rcpp::NumericVector& alpha, double beta, std::size_t n_particles, bool resampling, const Rcpp::List& particle_states, double seed);
+RcppExport SEXP _tomer_evaluate_left_to_right_resumable_cpp(SEXP corpusSEXP, SEXP alphabetSEXP, SEXP n_topicsSEXP, SEXP topic_countsSEXP, SEXP type_topic_countsSEXP, SEXP alphaSEXP, SEXP betaSEXP, SEXP n_particlesSEXP, SEXP resamplingSEXP, SEXP particle_statesSEXP, SEXP seedSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const Rcpp::List& >::type corpus(corpusSEXP);
+    Rcpp::traits::input_parameter< const Rcpp::DataFrame& >::type alphabet(alphabetSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type n_topics(n_topicsSEXP);
+    Rcpp::traits::input_parameter< const Rcpp::DataFrame& >::type topic_counts(topic_countsSEXP);
+    Rcpp::traits::input_parameter< const Rcpp::DataFrame& >::type type_topic_counts(type_topic_countsSEXP);
+    Rcpp::traits::input_parameter< const Rcpp::NumericVector& >::type alpha(alphaSEXP);
+    Rcpp::traits::input_parameter< double >::type beta(betaSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type n_particles(n_particlesSEXP);
+    Rcpp::traits::input_parameter< bool >::type resampling(resamplingSEXP);
+    Rcpp::traits::input_parameter< const Rcpp::List& >::type particle_states(particle_statesSEXP);
+    Rcpp::traits::input_parameter< double >::type seed(seedSEXP);
+    rcpp_result_gen = Rcpp::wrap(evaluate_left_to_right_resumable_cpp(corpus, alphabet, n_topics, topic_counts, type_topic_counts, alpha, beta, n_particles, resampling, particle_states, seed));
+    return rcpp_result_gen;
+END_RCPP
+}
+// export_shared_model_cpp
+void export_shared_model_cpp(const std::string& name, const Rcpp::DataFrame& alphabet, std::size_t n_topics, const Rcpp::DataFrame& topic_counts, const Rcpp::DataFrame& type_topic_counts, const Rcpp::NumericVector& alpha, double beta);
+RcppExport SEXP _tomer_export_shared_model_cpp(SEXP nameSEXP, SEXP alphabetSEXP, SEXP n_topicsSEXP, SEXP topic_countsSEXP, SEXP type_topic_countsSEXP, SEXP alphaSEXP, SEXP betaSEXP) {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const std::string& >::type name(nameSEXP);
+    Rcpp::traits::input_parameter< const Rcpp::DataFrame& >::type alphabet(alphabetSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type n_topics(n_topicsSEXP);
+    Rcpp::traits::input_parameter< const Rcpp::DataFrame& >::type topic_counts(topic_countsSEXP);
+    Rcpp::traits::input_parameter< const Rcpp::DataFrame& >::type type_topic_counts(type_topic_countsSEXP);
+    Rcpp::traits::input_parameter< const Rcpp::NumericVector& >::type alpha(alphaSEXP);
+    Rcpp::traits::input_parameter< double >::type beta(betaSEXP);
+    export_shared_model_cpp(name, alphabet, n_topics, topic_counts, type_topic_counts, alpha, beta);
+    return R_NilValue;
+END_RCPP
+}
+// attach_shared_model_cpp
+SEXP attach_shared_model_cpp(const std::string& name);
+RcppExport SEXP _tomer_attach_shared_model_cpp(SEXP nameSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const std::string& >::type name(nameSEXP);
+    rcpp_result_gen = Rcpp::wrap(attach_shared_model_cpp(name));
+    return rcpp_result_gen;
+END_RCPP
+}
+// remove_shared_model_cpp
+bool remove_shared_model_cpp(const std::string& name);
+RcppExport SEXP _tomer_remove_shared_model_cpp(SEXP nameSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const std::string& >::type name(nameSEXP);
+    rcpp_result_gen = Rcpp::wrap(remove_shared_model_cpp(name));
+    return rcpp_result_gen;
+END_RCPP
+}
+// evaluate_left_to_right_shared_cpp
+double evaluate_left_to_right_shared_cpp(SEXP corpus, SEXP model, std::size_t n_particles, bool resampling, std::size_t n_threads, const std::string& numa, double seed);
+RcppExport SEXP _tomer_evaluate_left_to_right_shared_cpp(SEXP corpusSEXP, SEXP modelSEXP, SEXP n_particlesSEXP, SEXP resamplingSEXP, SEXP n_threadsSEXP, SEXP numaSEXP, SEXP seedSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type corpus(corpusSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type model(modelSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type n_particles(n_particlesSEXP);
+    Rcpp::traits::input_parameter< bool >::type resampling(resamplingSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type n_threads(n_threadsSEXP);
+    Rcpp::traits::input_parameter< const std::string& >::type numa(numaSEXP);
+    Rcpp::traits::input_parameter< double >::type seed(seedSEXP);
+    rcpp_result_gen = Rcpp::wrap(evaluate_left_to_right_shared_cpp(corpus, model, n_particles, resampling, n_threads, numa, seed));
+    return rcpp_result_gen;
+END_RCPP
+}
+// read_mallet_word_topic_counts_cpp
+Rcpp::List read_mallet_word_topic_counts_cpp(const std::string& path, std::size_t n_topics, std::size_t n_threads);
+RcppExport SEXP _tomer_read_mallet_word_topic_counts_cpp(SEXP pathSEXP, SEXP n_topicsSEXP, SEXP n_threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const std::string& >::type path(pathSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type n_topics(n_topicsSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type n_threads(n_threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(read_mallet_word_topic_counts_cpp(path, n_topics, n_threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// read_mallet_topic_keys_cpp
+Rcpp::List read_mallet_topic_keys_cpp(const std::string& path);
+RcppExport SEXP _tomer_read_mallet_topic_keys_cpp(SEXP pathSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const std::string& >::type path(pathSEXP);
+    rcpp_result_gen = Rcpp::wrap(read_mallet_topic_keys_cpp(path));
+    return rcpp_result_gen;
+END_RCPP
+}
+// ppc_mutual_information_cpp
+Rcpp::List ppc_mutual_information_cpp(const Rcpp::DataFrame& state, std::size_t n_topics, std::size_t n_types, double beta, std::size_t n_replications, std::size_t n_threads, double seed);
+RcppExport SEXP _tomer_ppc_mutual_information_cpp(SEXP stateSEXP, SEXP n_topicsSEXP, SEXP n_typesSEXP, SEXP betaSEXP, SEXP n_replicationsSEXP, SEXP n_threadsSEXP, SEXP seedSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const Rcpp::DataFrame& >::type state(stateSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type n_topics(n_topicsSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type n_types(n_typesSEXP);
+    Rcpp::traits::input_parameter< double >::type beta(betaSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type n_replications(n_replicationsSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type n_threads(n_threadsSEXP);
+    Rcpp::traits::input_parameter< double >::type seed(seedSEXP);
+    rcpp_result_gen = Rcpp::wrap(ppc_mutual_information_cpp(state, n_topics, n_types, beta, n_replications, n_threads, seed));
+    return rcpp_result_gen;
+END_RCPP
+}
+// race_left_to_right_cpp
+Rcpp::List race_left_to_right_cpp(SEXP corpus, const Rcpp::List& models, std::size_t n_particles, bool resampling, double confidence, std::size_t min_docs, double seed);
+RcppExport SEXP _tomer_race_left_to_right_cpp(SEXP corpusSEXP, SEXP modelsSEXP, SEXP n_particlesSEXP, SEXP resamplingSEXP, SEXP confidenceSEXP, SEXP min_docsSEXP, SEXP seedSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type corpus(corpusSEXP);
+    Rcpp::traits::input_parameter< const Rcpp::List& >::type models(modelsSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type n_particles(n_particlesSEXP);
+    Rcpp::traits::input_parameter< bool >::type resampling(resamplingSEXP);
+    Rcpp::traits::input_parameter< double >::type confidence(confidenceSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type min_docs(min_docsSEXP);
+    Rcpp::traits::input_parameter< double >::type seed(seedSEXP);
+    rcpp_result_gen = Rcpp::wrap(race_left_to_right_cpp(corpus, models, n_particles, resampling, confidence, min_docs, seed));
+    return rcpp_result_gen;
+END_RCPP
+}
+// configure_thread_pool_cpp
+void configure_thread_pool_cpp(std::size_t size, const std::vector<int>& cpus, const std::string& name);
+RcppExport SEXP _tomer_configure_thread_pool_cpp(SEXP sizeSEXP, SEXP cpusSEXP, SEXP nameSEXP) {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::size_t >::type size(sizeSEXP);
+    Rcpp::traits::input_parameter< const std::vector<int>& >::type cpus(cpusSEXP);
+    Rcpp::traits::input_parameter< const std::string& >::type name(nameSEXP);
+    configure_thread_pool_cpp(size, cpus, name);
+    return R_NilValue;
+END_RCPP
+}
+// thread_pool_info_cpp
+Rcpp::List thread_pool_info_cpp();
+RcppExport SEXP _tomer_thread_pool_info_cpp() {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    rcpp_result_gen = Rcpp::wrap(thread_pool_info_cpp());
+    return rcpp_result_gen;
+END_RCPP
+}
+// shutdown_thread_pool_cpp
+void shutdown_thread_pool_cpp();
+RcppExport SEXP _tomer_shutdown_thread_pool_cpp() {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    shutdown_thread_pool_cpp();
+    return R_NilValue;
+END_RCPP
+}
+// encode_corpus_cpp
+SEXP encode_corpus_cpp(const Rcpp::List& corpus, SEXP alphabet);
+RcppExport SEXP _tomer_encode_corpus_cpp(SEXP corpusSEXP, SEXP alphabetSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const Rcpp::List& >::type corpus(corpusSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type alphabet(alphabetSEXP);
+    rcpp_result_gen = Rcpp::wrap(encode_corpus_cpp(corpus, alphabet));
+    return rcpp_result_gen;
+END_RCPP
+}
+// corpus_alphabet_cpp
+Rcpp::DataFrame corpus_alphabet_cpp(SEXP corpus);
+RcppExport SEXP _tomer_corpus_alphabet_cpp(SEXP corpusSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type corpus(corpusSEXP);
+    rcpp_result_gen = Rcpp::wrap(corpus_alphabet_cpp(corpus));
+    return rcpp_result_gen;
+END_RCPP
+}
+// corpus_types_cpp
+Rcpp::List corpus_types_cpp(SEXP corpus);
+RcppExport SEXP _tomer_corpus_types_cpp(SEXP corpusSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type corpus(corpusSEXP);
+    rcpp_result_gen = Rcpp::wrap(corpus_types_cpp(corpus));
+    return rcpp_result_gen;
+END_RCPP
+}
+// vocabulary_mapping_cpp
+Rcpp::DataFrame vocabulary_mapping_cpp(SEXP corpus, const Rcpp::DataFrame& alphabet);
+RcppExport SEXP _tomer_vocabulary_mapping_cpp(SEXP corpusSEXP, SEXP alphabetSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type corpus(corpusSEXP);
+    Rcpp::traits::input_parameter< const Rcpp::DataFrame& >::type alphabet(alphabetSEXP);
+    rcpp_result_gen = Rcpp::wrap(vocabulary_mapping_cpp(corpus, alphabet));
+    return rcpp_result_gen;
+END_RCPP
+}
+// corpus_size_cpp
+Rcpp::List corpus_size_cpp(SEXP corpus);
+RcppExport SEXP _tomer_corpus_size_cpp(SEXP corpusSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type corpus(corpusSEXP);
+    rcpp_result_gen = Rcpp::wrap(corpus_size_cpp(corpus));
+    return rcpp_result_gen;
+END_RCPP
+}
+// subset_corpus_cpp
+SEXP subset_corpus_cpp(SEXP corpus, const std::vector<std::size_t>& documents);
+RcppExport SEXP _tomer_subset_corpus_cpp(SEXP corpusSEXP, SEXP documentsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type corpus(corpusSEXP);
+    Rcpp::traits::input_parameter< const std::vector<std::size_t>& >::type documents(documentsSEXP);
+    rcpp_result_gen = Rcpp::wrap(subset_corpus_cpp(corpus, documents));
+    return rcpp_result_gen;
+END_RCPP
+}
+// shard_corpus_cpp
+SEXP shard_corpus_cpp(SEXP corpus, std::size_t begin, std::size_t end);
+RcppExport SEXP _tomer_shard_corpus_cpp(SEXP corpusSEXP, SEXP beginSEXP, SEXP endSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type corpus(corpusSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type begin(beginSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type end(endSEXP);
+    rcpp_result_gen = Rcpp::wrap(shard_corpus_cpp(corpus, begin, end));
+    return rcpp_result_gen;
+END_RCPP
+}
+// slice_documents_cpp
+SEXP slice_documents_cpp(SEXP corpus, double from, double to);
+RcppExport SEXP _tomer_slice_documents_cpp(SEXP corpusSEXP, SEXP fromSEXP, SEXP toSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type corpus(corpusSEXP);
+    Rcpp::traits::input_parameter< double >::type from(fromSEXP);
+    Rcpp::traits::input_parameter< double >::type to(toSEXP);
+    rcpp_result_gen = Rcpp::wrap(slice_documents_cpp(corpus, from, to));
+    return rcpp_result_gen;
+END_RCPP
+}
+// prune_vocabulary_cpp
+Rcpp::DataFrame prune_vocabulary_cpp(SEXP corpus, double min_count, double max_count, const std::vector<std::string>& stopwords, std::size_t n_threads);
+RcppExport SEXP _tomer_prune_vocabulary_cpp(SEXP corpusSEXP, SEXP min_countSEXP, SEXP max_countSEXP, SEXP stopwordsSEXP, SEXP n_threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type corpus(corpusSEXP);
+    Rcpp::traits::input_parameter< double >::type min_count(min_countSEXP);
+    Rcpp::traits::input_parameter< double >::type max_count(max_countSEXP);
+    Rcpp::traits::input_parameter< const std::vector<std::string>& >::type stopwords(stopwordsSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type n_threads(n_threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(prune_vocabulary_cpp(corpus, min_count, max_count, stopwords, n_threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// corpus_statistics_cpp
+Rcpp::List corpus_statistics_cpp(SEXP corpus, SEXP alphabet, std::size_t n_threads);
+RcppExport SEXP _tomer_corpus_statistics_cpp(SEXP corpusSEXP, SEXP alphabetSEXP, SEXP n_threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type corpus(corpusSEXP);
+    Rcpp::traits::input_parameter< SEXP >::type alphabet(alphabetSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type n_threads(n_threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(corpus_statistics_cpp(corpus, alphabet, n_threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// convert_word_vectors_cpp
+void convert_word_vectors_cpp(const std::string& input, const std::string& output, const std::string& format);
+RcppExport SEXP _tomer_convert_word_vectors_cpp(SEXP inputSEXP, SEXP outputSEXP, SEXP formatSEXP) {
+BEGIN_RCPP
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const std::string& >::type input(inputSEXP);
+    Rcpp::traits::input_parameter< const std::string& >::type output(outputSEXP);
+    Rcpp::traits::input_parameter< const std::string& >::type format(formatSEXP);
+    convert_word_vectors_cpp(input, output, format);
+    return R_NilValue;
+END_RCPP
+}
+// open_word_vectors_cpp
+SEXP open_word_vectors_cpp(const std::string& path);
+RcppExport SEXP _tomer_open_word_vectors_cpp(SEXP pathSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const std::string& >::type path(pathSEXP);
+    rcpp_result_gen = Rcpp::wrap(open_word_vectors_cpp(path));
+    return rcpp_result_gen;
+END_RCPP
+}
+// word_vectors_info_cpp
+Rcpp::List word_vectors_info_cpp(SEXP vectors);
+RcppExport SEXP _tomer_word_vectors_info_cpp(SEXP vectorsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type vectors(vectorsSEXP);
+    rcpp_result_gen = Rcpp::wrap(word_vectors_info_cpp(vectors));
+    return rcpp_result_gen;
+END_RCPP
+}
+// embedding_coherence_cpp
+Rcpp::NumericVector embedding_coherence_cpp(SEXP vectors, const Rcpp::List& topic_tokens, std::size_t n_threads);
+RcppExport SEXP _tomer_embedding_coherence_cpp(SEXP vectorsSEXP, SEXP topic_tokensSEXP, SEXP n_threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type vectors(vectorsSEXP);
+    Rcpp::traits::input_parameter< const Rcpp::List& >::type topic_tokens(topic_tokensSEXP);
+    Rcpp::traits::input_parameter< std::size_t >::type n_threads(n_threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(embedding_coherence_cpp(vectors, topic_tokens, n_threads));
     return rcpp_result_gen;
 END_RCPP
 }
 
 static const R_CallMethodDef CallEntries[] = {
-    {"_tomer_evaluate_left_to_right_cpp", (DL_FUNC) &_tomer_evaluate_left_to_right_cpp, 10},
+    {"_tomer_diff_checkpoints_cpp", (DL_FUNC) &_tomer_diff_checkpoints_cpp, 7},
+    {"_tomer_sample_corpus_cpp", (DL_FUNC) &_tomer_sample_corpus_cpp, 8},
+    {"_tomer_compress_alphabet_cpp", (DL_FUNC) &_tomer_compress_alphabet_cpp, 3},
+    {"_tomer_open_dictionary_cpp", (DL_FUNC) &_tomer_open_dictionary_cpp, 1},
+    {"_tomer_save_dictionary_cpp", (DL_FUNC) &_tomer_save_dictionary_cpp, 2},
+    {"_tomer_dictionary_types_cpp", (DL_FUNC) &_tomer_dictionary_types_cpp, 2},
+    {"_tomer_dictionary_tokens_cpp", (DL_FUNC) &_tomer_dictionary_tokens_cpp, 2},
+    {"_tomer_dictionary_info_cpp", (DL_FUNC) &_tomer_dictionary_info_cpp, 1},
+    {"_tomer_optimize_hyperparameters_cpp", (DL_FUNC) &_tomer_optimize_hyperparameters_cpp, 10},
+    {"_tomer_evaluate_importance_sampling_cpp", (DL_FUNC) &_tomer_evaluate_importance_sampling_cpp, 10},
+    {"_tomer_build_reference_index_cpp", (DL_FUNC) &_tomer_build_reference_index_cpp, 3},
+    {"_tomer_open_reference_index_cpp", (DL_FUNC) &_tomer_open_reference_index_cpp, 1},
+    {"_tomer_co_document_frequencies_cpp", (DL_FUNC) &_tomer_co_document_frequencies_cpp, 4},
+    {"_tomer_reference_index_documents_cpp", (DL_FUNC) &_tomer_reference_index_documents_cpp, 1},
+    {"_tomer_joint_log_likelihood_cpp", (DL_FUNC) &_tomer_joint_log_likelihood_cpp, 9},
+    {"_tomer_evaluate_left_to_right_cpp", (DL_FUNC) &_tomer_evaluate_left_to_right_cpp, 13},
+    {"_tomer_evaluate_left_to_right_encoded_cpp", (DL_FUNC) &_tomer_evaluate_left_to_right_encoded_cpp, 13},
+    {"_tomer_evaluate_left_to_right_diagnostics_cpp", (DL_FUNC) &_tomer_evaluate_left_to_right_diagnostics_cpp, 11},
+    {"_tomer_evaluate_left_to_right_anytime_cpp", (DL_FUNC) &_tomer_evaluate_left_to_right_anytime_cpp, 13},
+    {"_tomer_evaluate_left_to_right_resumable_cpp", (DL_FUNC) &_tomer_evaluate_left_to_right_resumable_cpp, 11},
+    {"_tomer_export_shared_model_cpp", (DL_FUNC) &_tomer_export_shared_model_cpp, 7},
+    {"_tomer_attach_shared_model_cpp", (DL_FUNC) &_tomer_attach_shared_model_cpp, 1},
+    {"_tomer_remove_shared_model_cpp", (DL_FUNC) &_tomer_remove_shared_model_cpp, 1},
+    {"_tomer_evaluate_left_to_right_shared_cpp", (DL_FUNC) &_tomer_evaluate_left_to_right_shared_cpp, 7},
+    {"_tomer_read_mallet_word_topic_counts_cpp", (DL_FUNC) &_tomer_read_mallet_word_topic_counts_cpp, 3},
+    {"_tomer_read_mallet_topic_keys_cpp", (DL_FUNC) &_tomer_read_mallet_topic_keys_cpp, 1},
+    {"_tomer_ppc_mutual_information_cpp", (DL_FUNC) &_tomer_ppc_mutual_information_cpp, 7},
+    {"_tomer_race_left_to_right_cpp", (DL_FUNC) &_tomer_race_left_to_right_cpp, 7},
+    {"_tomer_configure_thread_pool_cpp", (DL_FUNC) &_tomer_configure_thread_pool_cpp, 3},
+    {"_tomer_thread_pool_info_cpp", (DL_FUNC) &_tomer_thread_pool_info_cpp, 0},
+    {"_tomer_shutdown_thread_pool_cpp", (DL_FUNC) &_tomer_shutdown_thread_pool_cpp, 0},
+    {"_tomer_encode_corpus_cpp", (DL_FUNC) &_tomer_encode_corpus_cpp, 2},
+    {"_tomer_corpus_alphabet_cpp", (DL_FUNC) &_tomer_corpus_alphabet_cpp, 1},
+    {"_tomer_corpus_types_cpp", (DL_FUNC) &_tomer_corpus_types_cpp, 1},
+    {"_tomer_vocabulary_mapping_cpp", (DL_FUNC) &_tomer_vocabulary_mapping_cpp, 2},
+    {"_tomer_corpus_size_cpp", (DL_FUNC) &_tomer_corpus_size_cpp, 1},
+    {"_tomer_subset_corpus_cpp", (DL_FUNC) &_tomer_subset_corpus_cpp, 2},
+    {"_tomer_shard_corpus_cpp", (DL_FUNC) &_tomer_shard_corpus_cpp, 3},
+    {"_tomer_slice_documents_cpp", (DL_FUNC) &_tomer_slice_documents_cpp, 3},
+    {"_tomer_prune_vocabulary_cpp", (DL_FUNC) &_tomer_prune_vocabulary_cpp, 5},
+    {"_tomer_corpus_statistics_cpp", (DL_FUNC) &_tomer_corpus_statistics_cpp, 3},
+    {"_tomer_convert_word_vectors_cpp", (DL_FUNC) &_tomer_convert_word_vectors_cpp, 3},
+    {"_tomer_open_word_vectors_cpp", (DL_FUNC) &_tomer_open_word_vectors_cpp, 1},
+    {"_tomer_word_vectors_info_cpp", (DL_FUNC) &_tomer_word_vectors_info_cpp, 1},
+    {"_tomer_embedding_coherence_cpp", (DL_FUNC) &_tomer_embedding_coherence_cpp, 3},
     {NULL, NULL, 0}
 };
 
+void register_altrep_classes(DllInfo* dll);
 RcppExport void R_init_tomer(DllInfo *dll) {
     R_registerRoutines(dll, NULL, CallEntries, NULL, NULL);
     R_useDynamicSymbols(dll, FALSE);
+    register_altrep_classes(dll);
 }
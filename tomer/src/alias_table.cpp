@@ -0,0 +1,65 @@
+#include "alias_table.h"
+
+#include <numeric>
+#include <stdexcept>
+
+AliasTable::AliasTable()
+  : probabilities_{}, aliases_{}
+{
+
+}
+
+AliasTable::AliasTable(const DoubleVector& weights)
+  : probabilities_(weights.size()), aliases_(weights.size())
+{
+  size_type n = weights.size();
+  double total = std::accumulate(weights.cbegin(), weights.cend(), 0.0);
+
+  if (n == 0 || !(total > 0.0))
+    throw std::invalid_argument("alias table needs positive weights");
+
+  std::vector<size_type> small, large;
+  DoubleVector scaled(n);
+
+  for (size_type i = 0; i < n; ++i) {
+    scaled.at(i) = weights.at(i) * n / total;
+    if (scaled.at(i) < 1.0) small.push_back(i);
+    else large.push_back(i);
+  }
+
+  while (!small.empty() && !large.empty()) {
+    size_type s = small.back();
+    size_type l = large.back();
+    small.pop_back();
+
+    probabilities_.at(s) = scaled.at(s);
+    aliases_.at(s) = l;
+
+    scaled.at(l) -= 1.0 - scaled.at(s);
+    if (scaled.at(l) < 1.0) {
+      large.pop_back();
+      small.push_back(l);
+    }
+  }
+
+  // Whatever is left over is 1 up to rounding.
+  for (size_type i : large) {
+    probabilities_.at(i) = 1.0;
+    aliases_.at(i) = i;
+  }
+  for (size_type i : small) {
+    probabilities_.at(i) = 1.0;
+    aliases_.at(i) = i;
+  }
+}
+
+AliasTable::size_type AliasTable::sample(double u) const {
+  double x = u * probabilities_.size();
+  size_type i = static_cast<size_type>(x);
+  if (i >= probabilities_.size()) i = probabilities_.size() - 1;
+  return (x - i) < probabilities_[i] ? i : aliases_[i];
+}
+
+AliasTable::size_type AliasTable::size() const {
+  return probabilities_.size();
+}
@@ -0,0 +1,30 @@
+#ifndef ALIAS_TABLE_H
+#define ALIAS_TABLE_H
+
+#include <vector>
+
+#include "def.h"
+
+// Walker's alias method: after O(n) setup an outcome of a discrete
+// distribution with n outcomes is drawn in O(1) from a single uniform.
+class AliasTable {
+public:
+  using size_type = std::size_t;
+
+  AliasTable();
+  AliasTable(const DoubleVector& weights);
+
+  ~AliasTable() = default;
+
+  // u must be uniform in [0, 1).
+  size_type sample(double u) const;
+
+  size_type size() const;
+
+private:
+  DoubleVector probabilities_;
+  std::vector<size_type> aliases_;
+
+};
+
+#endif // ALIAS_TABLE_H
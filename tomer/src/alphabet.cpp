@@ -35,13 +35,21 @@ bool Alphabet::has(const Alphabet::Token& token) const {
   return alphabet_.find(token) != alphabet_.cend();
 }
 
-const Alphabet::Token& Alphabet::at(const Alphabet::Type& position) {
+const Alphabet::Token& Alphabet::at(const Alphabet::Type& position) const {
   return inv_alphabet_.at(position);
 }
-const Alphabet::Type& Alphabet::at(const Alphabet::Token& position) {
+const Alphabet::Type& Alphabet::at(const Alphabet::Token& position) const {
   return alphabet_.at(position);
 }
 
 Alphabet::size_type Alphabet::size() const {
   return alphabet_.size();
 }
+
+Alphabet::const_iterator Alphabet::begin() const {
+  return inv_alphabet_.cbegin();
+}
+
+Alphabet::const_iterator Alphabet::end() const {
+  return inv_alphabet_.cend();
+}
@@ -3,6 +3,7 @@
 
 #include <map>
 #include <memory>
+#include <string>
 
 class Alphabet {
 public:
@@ -10,6 +11,7 @@ public:
   using Type = std::size_t;
   using SPtr = std::shared_ptr<Alphabet>;
   using size_type = std::map<Token, Type>::size_type;
+  using const_iterator = std::map<Type, Token>::const_iterator;
 
   Alphabet();
   Alphabet(const std::map<Token, Type>& alphabet);
@@ -26,11 +28,15 @@ public:
   bool has(const Type& type) const;
   bool has(const Token& token) const;
 
-  const Token& at(const Type& position);
-  const Type& at(const Token& position);
+  const Token& at(const Type& position) const;
+  const Type& at(const Token& position) const;
 
   size_type size() const;
 
+  // Iterates over (type, token) pairs in increasing type order.
+  const_iterator begin() const;
+  const_iterator end() const;
+
 private:
   Type next_type_;
   std::map<Token, Type> alphabet_;
@@ -0,0 +1,75 @@
+#include "bag_of_words.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+const std::uint32_t BagOfWords::NONE;
+
+BagOfWords::BagOfWords()
+  : types_{}, counts_{}, length_{0}
+{
+
+}
+
+BagOfWords::BagOfWords(const TypeSequence& types, BagOfWords::SlotVector& slots)
+  : types_{}, counts_{}, length_{types.length()}
+{
+  for (size_type position = 0; position < length_; ++position) {
+    CompactType type = types.at(position);
+    std::uint32_t& slot = slots.at(type);
+
+    if (slot == NONE) {
+      slot = types_.size();
+      types_.push_back(type);
+      counts_.push_back(0);
+    }
+
+    ++counts_[slot];
+  }
+
+  for (CompactType type : types_) slots[type] = NONE;
+
+  types_.shrink_to_fit();
+  counts_.shrink_to_fit();
+}
+
+BagOfWords::BagOfWords(const TypeSequence& types)
+  : types_{}, counts_{}, length_{types.length()}
+{
+  std::vector<CompactType> sorted(length_);
+  for (size_type position = 0; position < length_; ++position) sorted[position] = types.at(position);
+  std::sort(sorted.begin(), sorted.end());
+
+  for (size_type i = 0; i < length_;) {
+    size_type j = i;
+    while (j < length_ && sorted[j] == sorted[i]) ++j;
+
+    types_.push_back(sorted[i]);
+    counts_.push_back(j - i);
+    i = j;
+  }
+}
+
+BagOfWords::CompactType BagOfWords::type_at(BagOfWords::size_type i) const {
+  return types_.at(i);
+}
+
+std::uint32_t BagOfWords::count_at(BagOfWords::size_type i) const {
+  return counts_.at(i);
+}
+
+BagOfWords::size_type BagOfWords::size() const {
+  return types_.size();
+}
+
+BagOfWords::size_type BagOfWords::length() const {
+  return length_;
+}
+
+const std::vector<BagOfWords::CompactType>& BagOfWords::types() const {
+  return types_;
+}
+
+const std::vector<std::uint32_t>& BagOfWords::counts() const {
+  return counts_;
+}
@@ -0,0 +1,55 @@
+#ifndef BAG_OF_WORDS_H
+#define BAG_OF_WORDS_H
+
+#include <cstdint>
+#include <vector>
+
+#include "type_sequence.h"
+
+// A document as its distinct types and how often each occurs, for
+// computations that do not depend on token order. Repetitive documents
+// become much shorter, so such computations can do their work once per
+// distinct type and weight it by the count.
+class BagOfWords {
+public:
+  using CompactType = TypeSequence::CompactType;
+  using size_type = std::size_t;
+
+  // Marks a type that has no slot in a SlotVector.
+  static const std::uint32_t NONE = static_cast<std::uint32_t>(-1);
+
+  // Scratch space of one entry per type of the alphabet, all NONE, that
+  // lets a bag be built in a single pass over the document. It is left all
+  // NONE again, so one vector serves any number of documents of a thread.
+  using SlotVector = std::vector<std::uint32_t>;
+
+  BagOfWords();
+
+  // Types are in order of their first occurrence.
+  BagOfWords(const TypeSequence& types, SlotVector& slots);
+
+  // Types are sorted.
+  explicit BagOfWords(const TypeSequence& types);
+
+  ~BagOfWords() = default;
+
+  CompactType type_at(size_type i) const;
+  std::uint32_t count_at(size_type i) const;
+
+  // Number of distinct types.
+  size_type size() const;
+
+  // Number of tokens.
+  size_type length() const;
+
+  const std::vector<CompactType>& types() const;
+  const std::vector<std::uint32_t>& counts() const;
+
+private:
+  std::vector<CompactType> types_;
+  std::vector<std::uint32_t> counts_;
+  size_type length_;
+
+};
+
+#endif // BAG_OF_WORDS_H
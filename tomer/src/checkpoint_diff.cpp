@@ -0,0 +1,197 @@
+#include "checkpoint_diff.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+#include "parallel.h"
+
+namespace {
+
+const std::size_t TYPE_GRAIN = 1024;
+
+}
+
+CheckpointDiff::Counts::Counts(std::size_t n_types,
+                               const TypeVector& types,
+                               const IntVector& topics,
+                               const CountVector& counts)
+  : row_offsets(n_types + 1, 0), topics{}, counts{}
+{
+  std::size_t n_entries = types.size();
+
+  if (topics.size() != n_entries || counts.size() != n_entries)
+    throw std::invalid_argument("types, topics and counts must have the same length");
+
+  // Counting sort of the entries by type.
+  for (std::size_t i = 0; i < n_entries; ++i) {
+    if (types[i] >= n_types)
+      throw std::out_of_range("type out of range");
+    ++row_offsets[types[i] + 1];
+  }
+  std::partial_sum(row_offsets.begin(), row_offsets.end(), row_offsets.begin());
+
+  std::vector<std::pair<uint, Count>> entries(n_entries);
+  std::vector<std::size_t> next(row_offsets.cbegin(), row_offsets.cend() - 1);
+  for (std::size_t i = 0; i < n_entries; ++i) {
+    entries[next[types[i]]++] = std::make_pair(topics[i], counts[i]);
+  }
+
+  // Rows are sorted by topic and duplicate topics merged, which may shorten
+  // them.
+  std::size_t position = 0;
+  for (std::size_t type = 0; type < n_types; ++type) {
+    auto begin = entries.begin() + row_offsets[type];
+    auto end = entries.begin() + row_offsets[type + 1];
+    std::sort(begin, end);
+
+    row_offsets[type] = position;
+    for (auto entry = begin; entry != end; ++entry) {
+      if (position > row_offsets[type] && entries[position - 1].first == entry->first)
+        entries[position - 1].second += entry->second;
+      else
+        entries[position++] = *entry;
+    }
+  }
+  row_offsets[n_types] = position;
+
+  this->topics.reserve(position);
+  this->counts.reserve(position);
+  for (std::size_t i = 0; i < position; ++i) {
+    this->topics.push_back(entries[i].first);
+    this->counts.push_back(entries[i].second);
+  }
+}
+
+std::size_t CheckpointDiff::Counts::n_types() const {
+  return row_offsets.size() - 1;
+}
+
+CheckpointDiff::CheckpointDiff(std::size_t n_topics)
+  : n_topics_{n_topics}
+{
+
+}
+
+CountVector CheckpointDiff::topic_sizes(const CheckpointDiff::Counts& counts, std::size_t n_threads) const {
+  std::vector<CountVector> local(n_threads);
+
+  parallel_for(0, counts.n_types(), n_threads, [&](std::size_t type, std::size_t thread) {
+    CountVector& sizes = local[thread];
+    if (sizes.empty()) sizes.assign(n_topics_, 0);
+
+    for (std::size_t i = counts.row_offsets[type]; i < counts.row_offsets[type + 1]; ++i) {
+      if (counts.topics[i] >= n_topics_)
+        throw std::out_of_range("topic out of range");
+      sizes[counts.topics[i]] += counts.counts[i];
+    }
+  }, TYPE_GRAIN);
+
+  CountVector sizes(n_topics_, 0);
+  for (auto const& part : local) {
+    for (std::size_t topic = 0; topic < part.size(); ++topic) sizes[topic] += part[topic];
+  }
+
+  return sizes;
+}
+
+CheckpointDiff::Result CheckpointDiff::compare(const CheckpointDiff::Counts& before,
+                                               const CheckpointDiff::Counts& after,
+                                               std::size_t n_top_types,
+                                               std::size_t n_threads) const {
+  std::size_t n_types = before.n_types();
+
+  if (after.n_types() != n_types)
+    throw std::invalid_argument("both checkpoints must have the same types");
+
+  if (n_threads == 0) n_threads = default_n_threads();
+
+  Result result;
+  result.topic_sizes_before = topic_sizes(before, n_threads);
+  result.topic_sizes_after = topic_sizes(after, n_threads);
+
+  DoubleVector scale_before(n_topics_, 0.0);
+  DoubleVector scale_after(n_topics_, 0.0);
+  for (std::size_t topic = 0; topic < n_topics_; ++topic) {
+    if (result.topic_sizes_before[topic] > 0) scale_before[topic] = 1.0 / result.topic_sizes_before[topic];
+    if (result.topic_sizes_after[topic] > 0) scale_after[topic] = 1.0 / result.topic_sizes_after[topic];
+  }
+
+  CountVector shifts(n_types, 0);
+  std::vector<std::int64_t> changes(n_types, 0);
+  std::vector<DoubleVector> distances(n_threads);
+
+  parallel_for(0, n_types, n_threads, [&](std::size_t type, std::size_t thread) {
+    DoubleVector& distance = distances[thread];
+    if (distance.empty()) distance.assign(n_topics_, 0.0);
+
+    std::size_t i = before.row_offsets[type];
+    std::size_t j = after.row_offsets[type];
+    std::size_t i_end = before.row_offsets[type + 1];
+    std::size_t j_end = after.row_offsets[type + 1];
+
+    Count shift = 0;
+    std::int64_t change = 0;
+
+    while (i < i_end || j < j_end) {
+      uint topic;
+      Count count_before = 0;
+      Count count_after = 0;
+
+      if (j == j_end || (i < i_end && before.topics[i] < after.topics[j])) {
+        topic = before.topics[i];
+        count_before = before.counts[i++];
+      } else if (i == i_end || after.topics[j] < before.topics[i]) {
+        topic = after.topics[j];
+        count_after = after.counts[j++];
+      } else {
+        topic = before.topics[i];
+        count_before = before.counts[i++];
+        count_after = after.counts[j++];
+      }
+
+      if (topic >= n_topics_)
+        throw std::out_of_range("topic out of range");
+
+      distance[topic] += std::abs(count_before * scale_before[topic] - count_after * scale_after[topic]);
+      shift += count_before > count_after ? count_before - count_after : count_after - count_before;
+      change += static_cast<std::int64_t>(count_after) - static_cast<std::int64_t>(count_before);
+    }
+
+    shifts[type] = shift;
+    changes[type] = change;
+  }, TYPE_GRAIN);
+
+  result.topic_drift.assign(n_topics_, 0.0);
+  for (auto const& distance : distances) {
+    for (std::size_t topic = 0; topic < distance.size(); ++topic) result.topic_drift[topic] += distance[topic];
+  }
+
+  // A topic that is empty in only one checkpoint has no distribution to
+  // compare with and counts as completely changed.
+  for (std::size_t topic = 0; topic < n_topics_; ++topic) {
+    bool empty_before = result.topic_sizes_before[topic] == 0;
+    bool empty_after = result.topic_sizes_after[topic] == 0;
+
+    result.topic_drift[topic] = empty_before != empty_after ? 1.0 : 0.5 * result.topic_drift[topic];
+  }
+
+  result.total_shift = std::accumulate(shifts.cbegin(), shifts.cend(), Count{0});
+
+  TypeVector order(n_types);
+  std::iota(order.begin(), order.end(), 0);
+
+  n_top_types = std::min(n_top_types, n_types);
+  std::partial_sort(order.begin(), order.begin() + n_top_types, order.end(), [&](Type a, Type b) {
+      return shifts[a] > shifts[b] || (shifts[a] == shifts[b] && a < b);
+    });
+
+  for (std::size_t i = 0; i < n_top_types && shifts[order[i]] > 0; ++i) {
+    result.top_types.push_back(order[i]);
+    result.top_type_shifts.push_back(shifts[order[i]]);
+    result.top_type_changes.push_back(changes[order[i]]);
+  }
+
+  return result;
+}
@@ -0,0 +1,67 @@
+#ifndef CHECKPOINT_DIFF_H
+#define CHECKPOINT_DIFF_H
+
+#include <cstdint>
+#include <vector>
+
+#include "def.h"
+
+// Summarizes how the type-topic counts of two checkpoints of a model differ,
+// to decide whether a new checkpoint is worth evaluating again: the total
+// variation distance between the word distributions of every topic, and the
+// types whose counts shifted most. Both checkpoints are kept sparse and
+// their rows are merged type by type in parallel, so the cost is linear in
+// the number of nonzero counts.
+class CheckpointDiff {
+public:
+  // Nonzero type-topic counts in compressed rows: the topics and counts of
+  // type t are at [row_offsets[t], row_offsets[t + 1]), by increasing topic.
+  // Counts are 64-bit since duplicate entries are summed.
+  struct Counts {
+    std::vector<std::size_t> row_offsets;
+    IntVector topics;
+    CountVector counts;
+
+    // Builds the rows from (types[i], topics[i], counts[i]) in any order.
+    // Counts of the same type and topic are added up.
+    Counts(std::size_t n_types,
+           const TypeVector& types,
+           const IntVector& topics,
+           const CountVector& counts);
+
+    std::size_t n_types() const;
+  };
+
+  struct Result {
+    // Indexed by topic.
+    DoubleVector topic_drift;
+    CountVector topic_sizes_before;
+    CountVector topic_sizes_after;
+
+    // The types with the largest summed absolute count change over all
+    // topics, largest first, with that shift and their net count change.
+    TypeVector top_types;
+    CountVector top_type_shifts;
+    std::vector<std::int64_t> top_type_changes;
+
+    Count total_shift;
+  };
+
+  CheckpointDiff(std::size_t n_topics);
+
+  ~CheckpointDiff() = default;
+
+  // Both checkpoints must number their types alike.
+  Result compare(const Counts& before,
+                 const Counts& after,
+                 std::size_t n_top_types,
+                 std::size_t n_threads) const;
+
+private:
+  std::size_t n_topics_;
+
+  CountVector topic_sizes(const Counts& counts, std::size_t n_threads) const;
+
+};
+
+#endif // CHECKPOINT_DIFF_H
@@ -0,0 +1,85 @@
+#include "corpus_sampler.h"
+
+#include <numeric>
+#include <random>
+#include <stdexcept>
+
+#include "parallel.h"
+
+namespace {
+
+const std::size_t DOCUMENT_GRAIN = 64;
+
+}
+
+CorpusSampler::CorpusSampler(std::size_t n_topics,
+                             const DoubleVector& alpha,
+                             double beta,
+                             const IntMatrix& type_topic_counts,
+                             std::size_t n_threads)
+  : n_topics_{n_topics}, n_types_{type_topic_counts.size()}, alpha_{alpha}, topic_words_(n_topics)
+{
+  if (alpha_.size() != n_topics_)
+    throw std::invalid_argument("alpha must have one element per topic");
+
+  if (!(std::accumulate(alpha_.cbegin(), alpha_.cend(), 0.0) > 0))
+    throw std::invalid_argument("alpha must have a positive element");
+
+  if (n_types_ == 0)
+    throw std::invalid_argument("the model has no types");
+
+  parallel_for(0, n_topics_, n_threads, [&](std::size_t topic, std::size_t) {
+    DoubleVector weights(n_types_, beta);
+
+    for (std::size_t type = 0; type < n_types_; ++type) {
+      weights[type] += type_topic_counts[type].at(topic);
+    }
+
+    if (std::accumulate(weights.cbegin(), weights.cend(), 0.0) <= 0)
+      throw std::invalid_argument("topic " + std::to_string(topic) + " has no words and beta is 0");
+
+    topic_words_[topic] = AliasTable{weights};
+  });
+}
+
+void CorpusSampler::sample(const CorpusSampler::LengthVector& lengths,
+                           std::size_t n_threads,
+                           std::uint64_t seed,
+                           TypeSequenceBuilder& builder) const {
+  std::size_t n_docs = lengths.size();
+
+  TypeSequenceContainer::Offsets offsets(n_docs + 1, 0);
+  std::partial_sum(lengths.cbegin(), lengths.cend(), offsets.begin() + 1);
+
+  TypeSequenceBuilder::TypeVector types(offsets.back());
+
+  parallel_for(0, n_docs, n_threads, [&](std::size_t doc, std::size_t) {
+    std::mt19937_64 gen{seed + doc};
+    std::uniform_real_distribution<double> uniform{0.0, 1.0};
+
+    // Topic proportions from Dirichlet(alpha) as normalized gamma draws. If
+    // all of them underflow, as they can for very small alpha, the prior mean
+    // is used instead.
+    DoubleVector proportions(n_topics_);
+    double sum = 0;
+
+    for (std::size_t topic = 0; topic < n_topics_; ++topic) {
+      if (alpha_[topic] > 0) {
+        std::gamma_distribution<double> gamma{alpha_[topic], 1.0};
+        proportions[topic] = gamma(gen);
+      }
+      sum += proportions[topic];
+    }
+
+    if (sum <= 0) proportions = alpha_;
+
+    AliasTable topics{proportions};
+
+    for (std::size_t i = offsets[doc]; i < offsets[doc + 1]; ++i) {
+      std::size_t topic = topics.sample(uniform(gen));
+      types[i] = static_cast<TypeSequenceBuilder::CompactType>(topic_words_[topic].sample(uniform(gen)));
+    }
+  }, DOCUMENT_GRAIN);
+
+  builder.add(std::move(types), lengths);
+}
@@ -0,0 +1,46 @@
+#ifndef CORPUS_SAMPLER_H
+#define CORPUS_SAMPLER_H
+
+#include <cstdint>
+#include <vector>
+
+#include "def.h"
+#include "alias_table.h"
+#include "type_sequence_builder.h"
+
+// Draws synthetic corpora from the generative process of LDA with the
+// topic-word distributions of a fitted model: every document draws its topic
+// proportions from Dirichlet(alpha), then every token a topic and a word of
+// that topic. The smoothed word distribution of every topic is an alias
+// table, so a token costs two uniforms. Documents are drawn in parallel, each
+// from its own generator seeded with seed + document, so that a corpus
+// depends on the seed only.
+class CorpusSampler {
+public:
+  using LengthVector = std::vector<std::size_t>;
+
+  CorpusSampler(std::size_t n_topics,
+                const DoubleVector& alpha,
+                double beta,
+                const IntMatrix& type_topic_counts,
+                std::size_t n_threads);
+
+  ~CorpusSampler() = default;
+
+  // Adds one document of every length to the builder, whose alphabet must
+  // be the model's.
+  void sample(const LengthVector& lengths,
+              std::size_t n_threads,
+              std::uint64_t seed,
+              TypeSequenceBuilder& builder) const;
+
+private:
+  std::size_t n_topics_;
+  std::size_t n_types_;
+  DoubleVector alpha_;
+
+  std::vector<AliasTable> topic_words_;
+
+};
+
+#endif // CORPUS_SAMPLER_H
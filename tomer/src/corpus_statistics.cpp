@@ -0,0 +1,97 @@
+#include "corpus_statistics.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "bag_of_words.h"
+#include "parallel.h"
+
+namespace {
+
+const std::size_t DOCUMENT_GRAIN = 256;
+
+struct TypeStatistic {
+  Count term_frequency;
+  Count document_frequency;
+  std::size_t first_document;
+};
+
+struct Accumulator {
+  std::unordered_map<BagOfWords::CompactType, TypeStatistic> types;
+  BagOfWords::SlotVector slots;
+};
+
+}
+
+CorpusStatistics CorpusStatistics::compute(const TypeSequenceView& corpus,
+                                           const std::vector<bool>& in_model,
+                                           std::size_t n_threads) {
+  std::size_t n_docs = corpus.size();
+
+  std::size_t n_types = 0;
+  for (auto const& entry : corpus.alphabet()) n_types = std::max(n_types, entry.first + 1);
+
+  if (!in_model.empty() && in_model.size() < n_types)
+    throw std::invalid_argument("every type of the corpus needs a vocabulary flag");
+
+  if (n_threads == 0) n_threads = default_n_threads();
+
+  CorpusStatistics statistics;
+  statistics.document_lengths.assign(n_docs, 0);
+
+  std::vector<Accumulator> accumulators(n_threads);
+
+  parallel_for(0, n_docs, n_threads, [&](std::size_t doc, std::size_t thread) {
+    Accumulator& accumulator = accumulators[thread];
+    if (accumulator.slots.empty()) accumulator.slots.assign(n_types, BagOfWords::NONE);
+
+    BagOfWords bag{corpus.at(doc), accumulator.slots};
+    statistics.document_lengths[doc] = bag.length();
+
+    for (std::size_t i = 0; i < bag.size(); ++i) {
+      auto inserted = accumulator.types.insert(
+        std::make_pair(bag.type_at(i), TypeStatistic{0, 0, doc}));
+      TypeStatistic& statistic = inserted.first->second;
+
+      statistic.term_frequency += bag.count_at(i);
+      ++statistic.document_frequency;
+      statistic.first_document = std::min(statistic.first_document, doc);
+    }
+  }, DOCUMENT_GRAIN);
+
+  statistics.term_frequencies.assign(n_types, 0);
+  statistics.document_frequencies.assign(n_types, 0);
+  std::vector<std::size_t> first_documents(n_types, std::numeric_limits<std::size_t>::max());
+
+  for (auto& accumulator : accumulators) {
+    for (auto const& entry : accumulator.types) {
+      statistics.term_frequencies[entry.first] += entry.second.term_frequency;
+      statistics.document_frequencies[entry.first] += entry.second.document_frequency;
+      first_documents[entry.first] = std::min(first_documents[entry.first], entry.second.first_document);
+    }
+
+    accumulator = Accumulator{};
+  }
+
+  // Every type adds to the vocabulary from the document it first occurs in.
+  statistics.vocabulary_growth.assign(n_docs, 0);
+  statistics.n_tokens = 0;
+  statistics.n_oov_tokens = 0;
+
+  for (std::size_t type = 0; type < n_types; ++type) {
+    if (statistics.term_frequencies[type] == 0) continue;
+
+    ++statistics.vocabulary_growth[first_documents[type]];
+    statistics.n_tokens += statistics.term_frequencies[type];
+    if (!in_model.empty() && !in_model[type]) statistics.n_oov_tokens += statistics.term_frequencies[type];
+  }
+
+  std::partial_sum(statistics.vocabulary_growth.begin(),
+                   statistics.vocabulary_growth.end(),
+                   statistics.vocabulary_growth.begin());
+
+  return statistics;
+}
@@ -0,0 +1,37 @@
+#ifndef CORPUS_STATISTICS_H
+#define CORPUS_STATISTICS_H
+
+#include <vector>
+
+#include "def.h"
+#include "type_sequence_view.h"
+
+// Term and document frequencies, document lengths, out-of-vocabulary rate
+// and vocabulary growth of an encoded corpus, all computed in one parallel
+// pass. Every thread turns its documents into bags of words and accumulates
+// per-type statistics in a sparse table of its own; the tables are merged
+// once at the end.
+struct CorpusStatistics {
+  // Indexed by type.
+  CountVector term_frequencies;
+  CountVector document_frequencies;
+
+  // Indexed by document.
+  CountVector document_lengths;
+
+  // Number of distinct types in the first d + 1 documents.
+  CountVector vocabulary_growth;
+
+  Count n_tokens;
+
+  // Tokens whose type is not flagged as known, if flags were given.
+  Count n_oov_tokens;
+
+  // in_model flags the types of the corpus that the model knows, an empty
+  // vector counts no token as out of vocabulary.
+  static CorpusStatistics compute(const TypeSequenceView& corpus,
+                                  const std::vector<bool>& in_model,
+                                  std::size_t n_threads);
+};
+
+#endif // CORPUS_STATISTICS_H
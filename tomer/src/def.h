@@ -5,6 +5,7 @@
 #include <vector>
 #include <map>
 #include <memory>
+#include <cstdint>
 
 using Token = std::string;
 using Type = std::size_t;
@@ -12,7 +13,10 @@ using Type = std::size_t;
 using Document = std::vector<Token>;
 using Corpus = std::vector<Document>;
 
+using Count = std::uint64_t;
+
 using IntVector = std::vector<uint>;
+using CountVector = std::vector<Count>;
 using DoubleVector = std::vector<double>;
 using StringVector = Document;
 using TypeVector = std::vector<Type>;
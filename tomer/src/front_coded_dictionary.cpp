@@ -0,0 +1,497 @@
+#include "front_coded_dictionary.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+const char MAGIC[8] = {'T', 'O', 'M', 'E', 'R', 'F', 'C', '2'};
+const std::uint64_t ALIGNMENT = 8;
+const std::uint64_t NOT_FOUND = UINT64_MAX;
+
+// Average number of tokens per hash bucket.
+const std::uint64_t BUCKET_LOAD = 4;
+
+std::uint64_t align(std::uint64_t offset) {
+  return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+}
+
+void write_varint(std::string& out, std::uint64_t value) {
+  while (value >= 0x80) {
+    out.push_back(static_cast<char>(value | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<char>(value));
+}
+
+// Reads a varint that must end before end and fit in 64 bits.
+std::uint64_t read_varint(const unsigned char*& in, const unsigned char* end) {
+  std::uint64_t value = 0;
+  unsigned shift = 0;
+  while (in < end && *in & 0x80) {
+    if (shift > 56)
+      throw std::runtime_error("dictionary block is corrupt");
+    value |= static_cast<std::uint64_t>(*in++ & 0x7f) << shift;
+    shift += 7;
+  }
+  if (in == end || (shift == 63 && *in > 1))
+    throw std::runtime_error("dictionary block is corrupt");
+  return value | static_cast<std::uint64_t>(*in++) << shift;
+}
+
+// Whether n elements of element_size bytes starting at offset lie within the
+// first size bytes. Divides instead of multiplying so that corrupt counts
+// cannot overflow.
+bool fits(std::uint64_t offset, std::uint64_t n, std::uint64_t element_size, std::uint64_t size) {
+  return offset <= size && n <= (size - offset) / element_size;
+}
+
+// FNV-1a
+std::uint64_t hash_token(const std::string& token) {
+  std::uint64_t h = 14695981039346656037ULL;
+  for (unsigned char c : token) {
+    h ^= c;
+    h *= 1099511628211ULL;
+  }
+  return h;
+}
+
+std::uint64_t bucket_of(std::uint64_t hash, std::uint64_t n_buckets) {
+  return hash % n_buckets;
+}
+
+unsigned char fingerprint_of(std::uint64_t hash) {
+  return static_cast<unsigned char>(hash >> 56);
+}
+
+}
+
+const FrontCodedDictionary::size_type FrontCodedDictionary::DEFAULT_BLOCK_SIZE;
+const std::uint32_t FrontCodedDictionary::NONE;
+
+FrontCodedDictionary::FrontCodedDictionary(const Alphabet& alphabet,
+                                           FrontCodedDictionary::size_type block_size,
+                                           bool hash)
+  : storage_{}, mapping_{nullptr}, mapping_size_{0}
+{
+  std::vector<std::pair<Token, Type>> entries;
+  entries.reserve(alphabet.size());
+
+  for (auto const& entry : alphabet) {
+    entries.push_back(std::make_pair(entry.second, entry.first));
+  }
+
+  build(entries, block_size, hash);
+}
+
+FrontCodedDictionary::FrontCodedDictionary(const std::vector<FrontCodedDictionary::Token>& tokens,
+                                           const std::vector<FrontCodedDictionary::Type>& types,
+                                           FrontCodedDictionary::size_type block_size,
+                                           bool hash)
+  : storage_{}, mapping_{nullptr}, mapping_size_{0}
+{
+  if (tokens.size() != types.size())
+    throw std::invalid_argument("tokens and types must have the same length");
+
+  std::vector<std::pair<Token, Type>> entries;
+  entries.reserve(tokens.size());
+
+  for (size_type i = 0; i < tokens.size(); ++i) {
+    entries.push_back(std::make_pair(tokens[i], types[i]));
+  }
+
+  build(entries, block_size, hash);
+}
+
+FrontCodedDictionary::FrontCodedDictionary(void* mapping, FrontCodedDictionary::size_type size)
+  : storage_{}, mapping_{mapping}, mapping_size_{size}
+{
+  attach(mapping);
+}
+
+FrontCodedDictionary::~FrontCodedDictionary() {
+  if (mapping_ != nullptr) munmap(mapping_, mapping_size_);
+}
+
+void FrontCodedDictionary::build(std::vector<std::pair<Token, Type>>& entries,
+                                 FrontCodedDictionary::size_type block_size,
+                                 bool hash) {
+  if (block_size == 0)
+    throw std::invalid_argument("block size must be positive");
+
+  std::sort(entries.begin(), entries.end());
+
+  std::uint64_t n_tokens = entries.size();
+  std::uint64_t n_types = 0;
+
+  if (n_tokens >= NONE)
+    throw std::overflow_error("a dictionary holds at most " + std::to_string(NONE - 1) + " tokens");
+
+  for (std::uint64_t rank = 0; rank < n_tokens; ++rank) {
+    if (rank > 0 && entries[rank].first == entries[rank - 1].first)
+      throw std::invalid_argument("token '" + entries[rank].first + "' occurs more than once");
+    if (entries[rank].second >= NONE)
+      throw std::overflow_error("type " + std::to_string(entries[rank].second) +
+                                " does not fit in 32 bits");
+    n_types = std::max<std::uint64_t>(n_types, entries[rank].second + 1);
+  }
+
+  std::uint64_t n_blocks = (n_tokens + block_size - 1) / block_size;
+  std::vector<std::uint64_t> block_offsets(n_blocks + 1);
+  std::string blocks;
+
+  for (std::uint64_t rank = 0; rank < n_tokens; ++rank) {
+    const Token& token = entries[rank].first;
+
+    if (rank % block_size == 0) {
+      block_offsets[rank / block_size] = blocks.size();
+      write_varint(blocks, token.size());
+      blocks.append(token);
+      continue;
+    }
+
+    const Token& previous = entries[rank - 1].first;
+    std::uint64_t shared = 0;
+    std::uint64_t limit = std::min(previous.size(), token.size());
+    while (shared < limit && previous[shared] == token[shared]) ++shared;
+
+    write_varint(blocks, shared);
+    write_varint(blocks, token.size() - shared);
+    blocks.append(token, shared, std::string::npos);
+  }
+  block_offsets[n_blocks] = blocks.size();
+
+  std::uint64_t n_buckets = hash ? (n_tokens + BUCKET_LOAD - 1) / BUCKET_LOAD : 0;
+
+  Header header;
+  std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.n_tokens = n_tokens;
+  header.n_types = n_types;
+  header.block_size = block_size;
+  header.n_blocks = n_blocks;
+  header.n_buckets = n_buckets;
+  header.block_offsets_offset = align(sizeof(Header));
+  header.rank_types_offset = align(header.block_offsets_offset +
+                                   (n_blocks + 1) * sizeof(std::uint64_t));
+  header.type_ranks_offset = align(header.rank_types_offset + n_tokens * sizeof(std::uint32_t));
+  header.bucket_offsets_offset = align(header.type_ranks_offset + n_types * sizeof(std::uint32_t));
+  header.bucket_ranks_offset = align(header.bucket_offsets_offset +
+                                     (n_buckets > 0 ? n_buckets + 1 : 0) * sizeof(std::uint32_t));
+  header.fingerprints_offset = header.bucket_ranks_offset +
+    (n_buckets > 0 ? n_tokens : 0) * sizeof(std::uint32_t);
+  header.blocks_offset = align(header.fingerprints_offset + (n_buckets > 0 ? n_tokens : 0));
+  header.size = header.blocks_offset + blocks.size();
+
+  storage_.assign((header.size + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t), 0);
+  char* base = reinterpret_cast<char*>(storage_.data());
+
+  std::memcpy(base, &header, sizeof(Header));
+  std::memcpy(base + header.block_offsets_offset, block_offsets.data(),
+              block_offsets.size() * sizeof(std::uint64_t));
+  std::memcpy(base + header.blocks_offset, blocks.data(), blocks.size());
+
+  std::uint32_t* rank_types = reinterpret_cast<std::uint32_t*>(base + header.rank_types_offset);
+  std::uint32_t* type_ranks = reinterpret_cast<std::uint32_t*>(base + header.type_ranks_offset);
+
+  std::fill(type_ranks, type_ranks + n_types, NONE);
+
+  for (std::uint64_t rank = 0; rank < n_tokens; ++rank) {
+    rank_types[rank] = entries[rank].second;
+    type_ranks[entries[rank].second] = rank;
+  }
+
+  if (n_buckets > 0) {
+    std::uint32_t* bucket_offsets = reinterpret_cast<std::uint32_t*>(base + header.bucket_offsets_offset);
+    std::uint32_t* bucket_ranks = reinterpret_cast<std::uint32_t*>(base + header.bucket_ranks_offset);
+    unsigned char* fingerprints = reinterpret_cast<unsigned char*>(base + header.fingerprints_offset);
+    std::vector<std::uint64_t> hashes(n_tokens);
+
+    // The ranks are grouped by bucket with a counting sort.
+    for (std::uint64_t rank = 0; rank < n_tokens; ++rank) {
+      hashes[rank] = hash_token(entries[rank].first);
+      ++bucket_offsets[bucket_of(hashes[rank], n_buckets) + 1];
+    }
+
+    for (std::uint64_t bucket = 0; bucket < n_buckets; ++bucket) {
+      bucket_offsets[bucket + 1] += bucket_offsets[bucket];
+    }
+
+    std::vector<std::uint32_t> next(bucket_offsets, bucket_offsets + n_buckets);
+
+    for (std::uint64_t rank = 0; rank < n_tokens; ++rank) {
+      std::uint32_t i = next[bucket_of(hashes[rank], n_buckets)]++;
+      bucket_ranks[i] = rank;
+      fingerprints[i] = fingerprint_of(hashes[rank]);
+    }
+  }
+
+  attach(base);
+}
+
+void FrontCodedDictionary::attach(const void* base) {
+  const char* bytes = static_cast<const char*>(base);
+
+  header_ = static_cast<const Header*>(base);
+  block_offsets_ = reinterpret_cast<const std::uint64_t*>(bytes + header_->block_offsets_offset);
+  rank_types_ = reinterpret_cast<const std::uint32_t*>(bytes + header_->rank_types_offset);
+  type_ranks_ = reinterpret_cast<const std::uint32_t*>(bytes + header_->type_ranks_offset);
+  bucket_offsets_ = reinterpret_cast<const std::uint32_t*>(bytes + header_->bucket_offsets_offset);
+  bucket_ranks_ = reinterpret_cast<const std::uint32_t*>(bytes + header_->bucket_ranks_offset);
+  fingerprints_ = reinterpret_cast<const unsigned char*>(bytes + header_->fingerprints_offset);
+  blocks_ = reinterpret_cast<const unsigned char*>(bytes + header_->blocks_offset);
+}
+
+FrontCodedDictionary::SPtr FrontCodedDictionary::open(const std::string& path) {
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd == -1)
+    throw std::runtime_error("could not open dictionary '" + path + "': " + std::strerror(errno));
+
+  struct stat st;
+  if (fstat(fd, &st) == -1 || static_cast<std::size_t>(st.st_size) < sizeof(Header)) {
+    close(fd);
+    throw std::runtime_error("'" + path + "' is not a dictionary");
+  }
+
+  void* address = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+
+  if (address == MAP_FAILED)
+    throw std::runtime_error("could not map dictionary '" + path + "'");
+
+  const Header* header = static_cast<const Header*>(address);
+  if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 ||
+      header->size > static_cast<std::uint64_t>(st.st_size) ||
+      !is_valid(*header, static_cast<const char*>(address))) {
+    munmap(address, st.st_size);
+    throw std::runtime_error("'" + path + "' is not a dictionary");
+  }
+
+  return SPtr{new FrontCodedDictionary(address, st.st_size)};
+}
+
+bool FrontCodedDictionary::is_valid(const Header& header, const char* base) {
+  std::uint64_t size = header.size;
+  std::uint64_t n_tokens = header.n_tokens;
+  std::uint64_t n_types = header.n_types;
+  std::uint64_t block_size = header.block_size;
+  std::uint64_t n_blocks = header.n_blocks;
+  std::uint64_t n_buckets = header.n_buckets;
+  std::uint64_t n_hashed = n_buckets > 0 ? n_tokens : 0;
+
+  if (n_tokens >= NONE || n_types > NONE || block_size == 0 ||
+      n_blocks != n_tokens / block_size + (n_tokens % block_size != 0) ||
+      n_buckets > n_tokens)
+    return false;
+
+  // The counts are checked before one is added to them.
+  if (!fits(header.block_offsets_offset, n_blocks, sizeof(std::uint64_t), size) ||
+      !fits(header.block_offsets_offset, n_blocks + 1, sizeof(std::uint64_t), size) ||
+      !fits(header.rank_types_offset, n_tokens, sizeof(std::uint32_t), size) ||
+      !fits(header.type_ranks_offset, n_types, sizeof(std::uint32_t), size) ||
+      (n_buckets > 0 &&
+       !fits(header.bucket_offsets_offset, n_buckets + 1, sizeof(std::uint32_t), size)) ||
+      !fits(header.bucket_ranks_offset, n_hashed, sizeof(std::uint32_t), size) ||
+      !fits(header.fingerprints_offset, n_hashed, 1, size) ||
+      header.blocks_offset > size)
+    return false;
+
+  if (header.block_offsets_offset % sizeof(std::uint64_t) != 0 ||
+      header.rank_types_offset % sizeof(std::uint32_t) != 0 ||
+      header.type_ranks_offset % sizeof(std::uint32_t) != 0 ||
+      header.bucket_offsets_offset % sizeof(std::uint32_t) != 0 ||
+      header.bucket_ranks_offset % sizeof(std::uint32_t) != 0)
+    return false;
+
+  const std::uint64_t* block_offsets =
+    reinterpret_cast<const std::uint64_t*>(base + header.block_offsets_offset);
+  const std::uint32_t* rank_types =
+    reinterpret_cast<const std::uint32_t*>(base + header.rank_types_offset);
+  const std::uint32_t* type_ranks =
+    reinterpret_cast<const std::uint32_t*>(base + header.type_ranks_offset);
+
+  // Every block holds at least one token and lies within the block section.
+  for (std::uint64_t block = 0; block < n_blocks; ++block) {
+    if (block_offsets[block] >= block_offsets[block + 1]) return false;
+  }
+  if (block_offsets[n_blocks] > size - header.blocks_offset) return false;
+
+  for (std::uint64_t rank = 0; rank < n_tokens; ++rank) {
+    if (rank_types[rank] >= n_types) return false;
+  }
+
+  for (std::uint64_t type = 0; type < n_types; ++type) {
+    if (type_ranks[type] != NONE && type_ranks[type] >= n_tokens) return false;
+  }
+
+  if (n_buckets > 0) {
+    const std::uint32_t* bucket_offsets =
+      reinterpret_cast<const std::uint32_t*>(base + header.bucket_offsets_offset);
+    const std::uint32_t* bucket_ranks =
+      reinterpret_cast<const std::uint32_t*>(base + header.bucket_ranks_offset);
+
+    if (bucket_offsets[0] != 0 || bucket_offsets[n_buckets] != n_tokens) return false;
+    for (std::uint64_t bucket = 0; bucket < n_buckets; ++bucket) {
+      if (bucket_offsets[bucket] > bucket_offsets[bucket + 1]) return false;
+    }
+    for (std::uint64_t i = 0; i < n_tokens; ++i) {
+      if (bucket_ranks[i] >= n_tokens) return false;
+    }
+  }
+
+  // Every token must decode within its block, so that lookups need no
+  // further checks. This reads the whole dictionary once.
+  const unsigned char* blocks = reinterpret_cast<const unsigned char*>(base + header.blocks_offset);
+
+  try {
+    for (std::uint64_t block = 0; block < n_blocks; ++block) {
+      const unsigned char* in = blocks + block_offsets[block];
+      const unsigned char* end = blocks + block_offsets[block + 1];
+      std::uint64_t first = block * block_size;
+      std::uint64_t last = std::min(first + block_size, n_tokens);
+      std::uint64_t previous = 0;
+
+      for (std::uint64_t rank = first; rank < last; ++rank) {
+        std::uint64_t shared = rank == first ? 0 : read_varint(in, end);
+        std::uint64_t length = read_varint(in, end);
+
+        if (shared > previous || length > static_cast<std::uint64_t>(end - in)) return false;
+        in += length;
+        previous = shared + length;
+      }
+
+      if (in != end) return false;
+    }
+  } catch (const std::runtime_error&) {
+    return false;
+  }
+
+  return true;
+}
+
+void FrontCodedDictionary::save(const std::string& path) const {
+  std::ofstream out{path, std::ios::binary | std::ios::trunc};
+  out.write(reinterpret_cast<const char*>(header_), header_->size);
+
+  if (!out)
+    throw std::runtime_error("could not write dictionary '" + path + "'");
+}
+
+bool FrontCodedDictionary::has(const FrontCodedDictionary::Type& type) const {
+  return type < header_->n_types && type_ranks_[type] != NONE;
+}
+
+bool FrontCodedDictionary::has(const FrontCodedDictionary::Token& token) const {
+  return find(token) != NOT_FOUND;
+}
+
+FrontCodedDictionary::Token FrontCodedDictionary::at(const FrontCodedDictionary::Type& type) const {
+  if (!has(type))
+    throw std::out_of_range("type " + std::to_string(type) + " is not in the dictionary");
+
+  return decode(type_ranks_[type]);
+}
+
+FrontCodedDictionary::Type FrontCodedDictionary::at(const FrontCodedDictionary::Token& token) const {
+  std::uint64_t rank = find(token);
+  if (rank == NOT_FOUND)
+    throw std::out_of_range("token '" + token + "' is not in the dictionary");
+
+  return rank_types_[rank];
+}
+
+FrontCodedDictionary::size_type FrontCodedDictionary::size() const {
+  return header_->n_tokens;
+}
+
+FrontCodedDictionary::size_type FrontCodedDictionary::block_size() const {
+  return header_->block_size;
+}
+
+FrontCodedDictionary::size_type FrontCodedDictionary::bytes() const {
+  return header_->size;
+}
+
+std::uint64_t FrontCodedDictionary::find(const FrontCodedDictionary::Token& token) const {
+  std::uint64_t n_buckets = header_->n_buckets;
+  if (n_buckets == 0) return search(token);
+
+  std::uint64_t hash = hash_token(token);
+  std::uint64_t bucket = bucket_of(hash, n_buckets);
+  unsigned char fingerprint = fingerprint_of(hash);
+
+  for (std::uint32_t i = bucket_offsets_[bucket]; i < bucket_offsets_[bucket + 1]; ++i) {
+    if (fingerprints_[i] == fingerprint && decode(bucket_ranks_[i]) == token) return bucket_ranks_[i];
+  }
+
+  return NOT_FOUND;
+}
+
+std::uint64_t FrontCodedDictionary::search(const FrontCodedDictionary::Token& token) const {
+  // Finds the last block whose first token is not greater than the token.
+  std::uint64_t lo = 0;
+  std::uint64_t hi = header_->n_blocks;
+
+  while (lo < hi) {
+    std::uint64_t mid = lo + (hi - lo) / 2;
+    const unsigned char* in = blocks_ + block_offsets_[mid];
+    std::uint64_t length = read_varint(in, blocks_ + block_offsets_[mid + 1]);
+
+    if (token.compare(0, Token::npos, reinterpret_cast<const char*>(in), length) < 0)
+      hi = mid;
+    else
+      lo = mid + 1;
+  }
+
+  if (lo == 0) return NOT_FOUND;
+
+  std::uint64_t block = lo - 1;
+  std::uint64_t first = block * header_->block_size;
+  std::uint64_t last = std::min(first + header_->block_size, header_->n_tokens);
+
+  const unsigned char* in = blocks_ + block_offsets_[block];
+  const unsigned char* end = blocks_ + block_offsets_[block + 1];
+  Token current;
+
+  for (std::uint64_t rank = first; rank < last; ++rank) {
+    std::uint64_t shared = rank == first ? 0 : read_varint(in, end);
+    std::uint64_t length = read_varint(in, end);
+
+    current.resize(shared);
+    current.append(reinterpret_cast<const char*>(in), length);
+    in += length;
+
+    int order = current.compare(token);
+    if (order == 0) return rank;
+    if (order > 0) break;
+  }
+
+  return NOT_FOUND;
+}
+
+FrontCodedDictionary::Token FrontCodedDictionary::decode(std::uint64_t rank) const {
+  std::uint64_t block = rank / header_->block_size;
+  std::uint64_t first = block * header_->block_size;
+
+  const unsigned char* in = blocks_ + block_offsets_[block];
+  const unsigned char* end = blocks_ + block_offsets_[block + 1];
+  Token token;
+
+  for (std::uint64_t r = first; r <= rank; ++r) {
+    std::uint64_t shared = r == first ? 0 : read_varint(in, end);
+    std::uint64_t length = read_varint(in, end);
+
+    token.resize(shared);
+    token.append(reinterpret_cast<const char*>(in), length);
+    in += length;
+  }
+
+  return token;
+}
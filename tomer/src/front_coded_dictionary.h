@@ -0,0 +1,110 @@
+#ifndef FRONT_CODED_DICTIONARY_H
+#define FRONT_CODED_DICTIONARY_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "alphabet.h"
+
+// A read-only, compressed counterpart of Alphabet for very large
+// vocabularies. Tokens are sorted and front coded in blocks: the first token
+// of a block is stored in full and every following one as the length of the
+// prefix it shares with its predecessor plus the remaining suffix. Tokens are
+// found with a small hash table, or with a binary search over the first
+// tokens of the blocks, and a type is decoded from a single block.
+//
+// The hash table has no empty slots: the ranks of the tokens are grouped by
+// bucket, about four to a bucket, each with an 8-bit fingerprint of its hash
+// so that a lookup decodes little besides the token it looks for. It costs
+// about six bytes per token. Ranks are 32-bit, so a dictionary holds fewer
+// than 2^32 - 1 tokens.
+//
+// All data lives in one contiguous buffer that can be saved to a file and
+// mapped back into memory without parsing.
+class FrontCodedDictionary {
+public:
+  using Token = Alphabet::Token;
+  using Type = Alphabet::Type;
+  using SPtr = std::shared_ptr<const FrontCodedDictionary>;
+  using size_type = std::size_t;
+
+  static const size_type DEFAULT_BLOCK_SIZE = 16;
+
+  FrontCodedDictionary(const Alphabet& alphabet,
+                       size_type block_size = DEFAULT_BLOCK_SIZE,
+                       bool hash = true);
+  FrontCodedDictionary(const std::vector<Token>& tokens,
+                       const std::vector<Type>& types,
+                       size_type block_size = DEFAULT_BLOCK_SIZE,
+                       bool hash = true);
+  ~FrontCodedDictionary();
+
+  static SPtr open(const std::string& path);
+  void save(const std::string& path) const;
+
+  bool has(const Type& type) const;
+  bool has(const Token& token) const;
+
+  Token at(const Type& type) const;
+  Type at(const Token& token) const;
+
+  size_type size() const;
+  size_type block_size() const;
+
+  // Size of the dictionary in bytes.
+  size_type bytes() const;
+
+private:
+  struct Header {
+    char magic[8];
+    std::uint64_t n_tokens;
+    std::uint64_t n_types;
+    std::uint64_t block_size;
+    std::uint64_t n_blocks;
+    std::uint64_t n_buckets;
+    std::uint64_t block_offsets_offset;
+    std::uint64_t rank_types_offset;
+    std::uint64_t type_ranks_offset;
+    std::uint64_t bucket_offsets_offset;
+    std::uint64_t bucket_ranks_offset;
+    std::uint64_t fingerprints_offset;
+    std::uint64_t blocks_offset;
+    std::uint64_t size;
+  };
+
+  static const std::uint32_t NONE = UINT32_MAX;
+
+  std::vector<std::uint64_t> storage_;
+  void* mapping_;
+  size_type mapping_size_;
+
+  const Header* header_;
+  const std::uint64_t* block_offsets_;
+  const std::uint32_t* rank_types_;
+  const std::uint32_t* type_ranks_;
+  const std::uint32_t* bucket_offsets_;
+  const std::uint32_t* bucket_ranks_;
+  const unsigned char* fingerprints_;
+  const unsigned char* blocks_;
+
+  FrontCodedDictionary(void* mapping, size_type size);
+
+  void build(std::vector<std::pair<Token, Type>>& entries, size_type block_size, bool hash);
+  void attach(const void* base);
+
+  // Whether every section of the header lies within its size, which open
+  // has checked against the mapped size, and every block decodes.
+  static bool is_valid(const Header& header, const char* base);
+
+  std::uint64_t find(const Token& token) const;
+  std::uint64_t search(const Token& token) const;
+  Token decode(std::uint64_t rank) const;
+
+  FrontCodedDictionary(const FrontCodedDictionary& other) = delete;
+  FrontCodedDictionary& operator=(const FrontCodedDictionary& rhs) = delete;
+
+};
+
+#endif // FRONT_CODED_DICTIONARY_H
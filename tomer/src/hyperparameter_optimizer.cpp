@@ -0,0 +1,200 @@
+#include "hyperparameter_optimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace {
+
+const double TOLERANCE = 1e-8;
+
+// Smallest value a parameter is shrunk to, so that it stays positive.
+const double MIN_PARAMETER = 1e-10;
+
+double digamma(double x) {
+  double result = 0;
+
+  for (; x < 6; ++x) result -= 1 / x;
+
+  double f = 1 / (x * x);
+  return result + std::log(x) - 0.5 / x -
+    f * (1.0 / 12 - f * (1.0 / 120 - f * (1.0 / 252 - f * (1.0 / 240 - f * (1.0 / 132)))));
+}
+
+// Sum of frequency * (digamma(count + a) - digamma(a)) over a histogram,
+// the derivative of the log-likelihood of a Dirichlet-multinomial.
+double digamma_sum(const HyperparameterOptimizer::Histogram& histogram, double a) {
+  double base = digamma(a);
+  double sum = 0;
+
+  for (auto const& entry : histogram) {
+    sum += entry.second * (digamma(entry.first + a) - base);
+  }
+
+  return sum;
+}
+
+void add_to_histogram(std::unordered_map<Count, Count>& counts,
+                      HyperparameterOptimizer::Histogram& histogram) {
+  for (auto const& entry : histogram) counts[entry.first] += entry.second;
+
+  histogram.assign(counts.cbegin(), counts.cend());
+  std::sort(histogram.begin(), histogram.end());
+}
+
+}
+
+HyperparameterOptimizer::HyperparameterOptimizer(std::size_t n_topics, std::size_t n_types)
+  : n_topics_{n_topics},
+    n_types_{n_types},
+    document_lengths_{},
+    topic_document_counts_(n_topics),
+    type_topic_counts_{},
+    topic_sizes_(n_topics, 0)
+{
+
+}
+
+void HyperparameterOptimizer::add_documents(const IntVector& docs,
+                                            const IntVector& topics,
+                                            std::size_t n_docs) {
+  std::size_t n_tokens = docs.size();
+
+  if (topics.size() != n_tokens)
+    throw std::invalid_argument("docs and topics must have the same length");
+
+  // Counting sort of the tokens' topics by document.
+  std::vector<std::size_t> offsets(n_docs + 1, 0);
+  for (std::size_t i = 0; i < n_tokens; ++i) {
+    if (docs[i] >= n_docs || topics[i] >= n_topics_)
+      throw std::out_of_range("document or topic out of range");
+    ++offsets[docs[i] + 1];
+  }
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+  IntVector doc_topics(n_tokens);
+  std::vector<std::size_t> next(offsets.cbegin(), offsets.cend() - 1);
+  for (std::size_t i = 0; i < n_tokens; ++i) {
+    doc_topics[next[docs[i]]++] = topics[i];
+  }
+
+  std::unordered_map<Count, Count> lengths;
+  std::vector<std::unordered_map<Count, Count>> topic_counts(n_topics_);
+
+  CountVector counts(n_topics_, 0);
+  IntVector seen;
+
+  for (std::size_t doc = 0; doc < n_docs; ++doc) {
+    if (offsets[doc] == offsets[doc + 1]) continue;
+
+    ++lengths[offsets[doc + 1] - offsets[doc]];
+
+    for (std::size_t i = offsets[doc]; i < offsets[doc + 1]; ++i) {
+      if (counts[doc_topics[i]]++ == 0) seen.push_back(doc_topics[i]);
+    }
+
+    for (uint topic : seen) {
+      ++topic_counts[topic][counts[topic]];
+      counts[topic] = 0;
+    }
+    seen.clear();
+  }
+
+  add_to_histogram(lengths, document_lengths_);
+  for (std::size_t topic = 0; topic < n_topics_; ++topic) {
+    add_to_histogram(topic_counts[topic], topic_document_counts_[topic]);
+  }
+}
+
+void HyperparameterOptimizer::add_type_topic_counts(const IntVector& topics, const CountVector& counts) {
+  if (topics.size() != counts.size())
+    throw std::invalid_argument("topics and counts must have the same length");
+
+  std::unordered_map<Count, Count> histogram;
+
+  for (std::size_t i = 0; i < counts.size(); ++i) {
+    if (topics[i] >= n_topics_)
+      throw std::out_of_range("topic out of range");
+    if (counts[i] == 0) continue;
+
+    ++histogram[counts[i]];
+    topic_sizes_[topics[i]] += counts[i];
+  }
+
+  add_to_histogram(histogram, type_topic_counts_);
+}
+
+DoubleVector HyperparameterOptimizer::optimize_alpha(const DoubleVector& alpha,
+                                                     std::size_t n_iterations,
+                                                     double shape,
+                                                     double scale) const {
+  if (alpha.size() != n_topics_)
+    throw std::invalid_argument("alpha must have one element per topic");
+
+  if (std::any_of(alpha.cbegin(), alpha.cend(), [](double a) { return !(a > 0); }))
+    throw std::invalid_argument("alpha must be positive");
+  if (document_lengths_.empty())
+    throw std::invalid_argument("alpha cannot be optimized without documents");
+
+  DoubleVector parameters{alpha};
+
+  for (std::size_t iteration = 0; iteration < n_iterations; ++iteration) {
+    double sum = std::accumulate(parameters.cbegin(), parameters.cend(), 0.0);
+    double likelihood_denominator = digamma_sum(document_lengths_, sum);
+
+    // A prior whose rate outweighs the documents leaves no positive update,
+    // the maximum likelihood update is taken instead.
+    bool use_prior = likelihood_denominator - 1 / scale > 0;
+    double denominator = use_prior ? likelihood_denominator - 1 / scale : likelihood_denominator;
+    double change = 0;
+
+    for (std::size_t topic = 0; topic < n_topics_; ++topic) {
+      double old = parameters[topic];
+      double numerator = old * digamma_sum(topic_document_counts_[topic], old) + (use_prior ? shape : 0);
+
+      parameters[topic] = std::max(numerator / denominator, MIN_PARAMETER);
+      change = std::max(change, std::abs(parameters[topic] - old) / old);
+    }
+
+    if (change < TOLERANCE) break;
+  }
+
+  return parameters;
+}
+
+double HyperparameterOptimizer::optimize_beta(double beta, std::size_t n_iterations) const {
+  if (!(beta > 0))
+    throw std::invalid_argument("beta must be positive");
+
+  for (std::size_t iteration = 0; iteration < n_iterations; ++iteration) {
+    double beta_sum = beta * n_types_;
+    double numerator = digamma_sum(type_topic_counts_, beta);
+
+    double denominator = 0;
+    double base = digamma(beta_sum);
+    for (Count size : topic_sizes_) {
+      if (size > 0) denominator += digamma(size + beta_sum) - base;
+    }
+
+    if (denominator <= 0)
+      throw std::invalid_argument("beta cannot be optimized without type-topic counts");
+
+    double old = beta;
+    beta = std::max(beta * numerator / (n_types_ * denominator), MIN_PARAMETER);
+
+    if (std::abs(beta - old) / old < TOLERANCE) break;
+  }
+
+  return beta;
+}
+
+const HyperparameterOptimizer::Histogram& HyperparameterOptimizer::document_lengths() const {
+  return document_lengths_;
+}
+
+const HyperparameterOptimizer::Histogram&
+HyperparameterOptimizer::topic_document_counts(std::size_t topic) const {
+  return topic_document_counts_.at(topic);
+}
@@ -0,0 +1,61 @@
+#ifndef HYPERPARAMETER_OPTIMIZER_H
+#define HYPERPARAMETER_OPTIMIZER_H
+
+#include <utility>
+#include <vector>
+
+#include "def.h"
+
+// Optimizes the Dirichlet priors of a topic model by Minka's fixed-point
+// iteration, the way MALLET does: the likelihood of asymmetric alpha only
+// depends on how many documents have n tokens and how many have n tokens of
+// each topic, that of symmetric beta on how many type-topic pairs have count
+// n and on the topic sizes. These histograms are built once from a training
+// or fold-in state, after which every iteration is independent of the corpus
+// size.
+//
+// Unlike MALLET, histograms are sparse and the digamma differences are
+// computed directly, so that large counts do not need dense histograms.
+class HyperparameterOptimizer {
+public:
+  // Pairs of a count and the number of times it occurs, by increasing count.
+  using Histogram = std::vector<std::pair<Count, Count>>;
+
+  HyperparameterOptimizer(std::size_t n_topics, std::size_t n_types);
+
+  ~HyperparameterOptimizer() = default;
+
+  // Adds documents given by the document and topic of every token, documents
+  // numbered 0, ..., n_docs - 1 and tokens in any order.
+  void add_documents(const IntVector& docs, const IntVector& topics, std::size_t n_docs);
+
+  // Adds nonzero type-topic counts, each given by its topic and count, and
+  // the sizes of all topics.
+  void add_type_topic_counts(const IntVector& topics, const CountVector& counts);
+
+  // Runs at most n_iterations updates, or until no element changes by more
+  // than a relative tolerance. Alpha has a Gamma(shape, scale) prior; shape 0
+  // and infinite scale give the maximum likelihood update, which is also used
+  // in iterations where the rate 1 / scale outweighs the documents.
+  DoubleVector optimize_alpha(const DoubleVector& alpha,
+                              std::size_t n_iterations,
+                              double shape,
+                              double scale) const;
+  double optimize_beta(double beta, std::size_t n_iterations) const;
+
+  const Histogram& document_lengths() const;
+  const Histogram& topic_document_counts(std::size_t topic) const;
+
+private:
+  std::size_t n_topics_;
+  std::size_t n_types_;
+
+  Histogram document_lengths_;
+  std::vector<Histogram> topic_document_counts_;
+
+  Histogram type_topic_counts_;
+  CountVector topic_sizes_;
+
+};
+
+#endif // HYPERPARAMETER_OPTIMIZER_H
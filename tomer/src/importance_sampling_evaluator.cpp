@@ -0,0 +1,145 @@
+#include "importance_sampling_evaluator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+
+#include "parallel.h"
+
+namespace {
+
+const std::size_t DOCUMENT_GRAIN = 16;
+
+}
+
+ImportanceSamplingEvaluator::ImportanceSamplingEvaluator(std::size_t n_topics,
+                                                         const DoubleVector& alpha,
+                                                         double beta,
+                                                         const CountVector& topic_counts,
+                                                         const IntMatrix& type_topic_counts)
+  : n_topics_{n_topics},
+    n_types_{type_topic_counts.size()},
+    alpha_{alpha},
+    topic_words_(n_types_ * n_topics_),
+    seed_{std::random_device{}()},
+    type_mapping_{}
+{
+  if (alpha_.size() != n_topics_)
+    throw std::invalid_argument("alpha must have one element per topic");
+
+  if (topic_counts.size() != n_topics_)
+    throw std::invalid_argument("topic counts must have one element per topic");
+
+  if (!(std::accumulate(alpha_.cbegin(), alpha_.cend(), 0.0) > 0))
+    throw std::invalid_argument("alpha must have a positive element");
+
+  if (!(beta > 0))
+    throw std::invalid_argument("beta must be positive");
+
+  double beta_sum = n_types_ * beta;
+
+  for (std::size_t type = 0; type < n_types_; ++type) {
+    for (std::size_t topic = 0; topic < n_topics_; ++topic) {
+      topic_words_[type * n_topics_ + topic] =
+        (type_topic_counts[type].at(topic) + beta) / (topic_counts[topic] + beta_sum);
+    }
+  }
+}
+
+void ImportanceSamplingEvaluator::set_seed(std::uint64_t seed) {
+  seed_ = seed;
+}
+
+void ImportanceSamplingEvaluator::set_type_mapping(const TypeMapping& mapping) {
+  type_mapping_.reset(new TypeMapping{mapping});
+}
+
+// Unmapped types are beyond every model and thus skipped like any other type
+// the model does not know.
+std::size_t ImportanceSamplingEvaluator::model_type(std::size_t type) const {
+  return type_mapping_ ? type_mapping_->at(type) : type;
+}
+
+DoubleVector ImportanceSamplingEvaluator::evaluate_documents(const TypeSequenceView& corpus,
+                                                             std::size_t n_samples,
+                                                             std::size_t n_threads) const {
+  std::size_t n_corpus_types = 0;
+  for (auto const& entry : corpus.alphabet()) n_corpus_types = std::max(n_corpus_types, entry.first + 1);
+
+  if (n_threads == 0) n_threads = default_n_threads();
+
+  DoubleVector log_likelihoods(corpus.size(), 0);
+  std::vector<BagOfWords::SlotVector> slots(n_threads);
+
+  parallel_for(0, corpus.size(), n_threads, [&](std::size_t doc, std::size_t thread) {
+    if (slots[thread].empty()) slots[thread].assign(n_corpus_types, BagOfWords::NONE);
+
+    log_likelihoods[doc] = evaluate(BagOfWords{corpus.at(doc), slots[thread]}, n_samples, seed_ + doc);
+  }, DOCUMENT_GRAIN);
+
+  return log_likelihoods;
+}
+
+double ImportanceSamplingEvaluator::evaluate(const BagOfWords& document,
+                                             std::size_t n_samples,
+                                             std::uint64_t seed) const {
+  if (n_samples == 0)
+    throw std::invalid_argument("importance sampling needs at least one sample");
+
+  // The topic-word rows and counts of the distinct types the model knows.
+  std::vector<const double*> rows;
+  std::vector<std::uint32_t> counts;
+
+  for (std::size_t i = 0; i < document.size(); ++i) {
+    std::size_t type = model_type(document.type_at(i));
+    if (type >= n_types_) continue;
+
+    rows.push_back(&topic_words_[type * n_topics_]);
+    counts.push_back(document.count_at(i));
+  }
+
+  if (rows.empty()) return 0;
+
+  std::mt19937_64 gen{seed};
+  DoubleVector proportions(n_topics_);
+  DoubleVector log_weights(n_samples);
+
+  for (std::size_t sample = 0; sample < n_samples; ++sample) {
+    // Topic proportions as normalized gamma draws. If all of them underflow,
+    // as they can for very small alpha, the prior mean is used instead.
+    double sum = 0;
+
+    for (std::size_t topic = 0; topic < n_topics_; ++topic) {
+      proportions[topic] = 0;
+      if (alpha_[topic] > 0) {
+        std::gamma_distribution<double> gamma{alpha_[topic], 1.0};
+        proportions[topic] = gamma(gen);
+      }
+      sum += proportions[topic];
+    }
+
+    if (sum <= 0) {
+      proportions = alpha_;
+      sum = std::accumulate(alpha_.cbegin(), alpha_.cend(), 0.0);
+    }
+
+    double log_weight = 0;
+
+    for (std::size_t i = 0; i < rows.size(); ++i) {
+      double probability = std::inner_product(proportions.cbegin(), proportions.cend(), rows[i], 0.0);
+      log_weight += counts[i] * std::log(probability / sum);
+    }
+
+    log_weights[sample] = log_weight;
+  }
+
+  // log of the mean weight, relative to the largest so that it does not
+  // underflow for long documents.
+  double max = *std::max_element(log_weights.cbegin(), log_weights.cend());
+  double total = 0;
+  for (double log_weight : log_weights) total += std::exp(log_weight - max);
+
+  return max + std::log(total / n_samples);
+}
@@ -0,0 +1,68 @@
+#ifndef IMPORTANCE_SAMPLING_EVALUATOR_H
+#define IMPORTANCE_SAMPLING_EVALUATOR_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "def.h"
+#include "bag_of_words.h"
+#include "type_mapping.h"
+#include "type_sequence_view.h"
+
+// Estimates the log-likelihood of held-out documents by importance sampling
+// from the prior (Wallach et al., 2009): every sample draws the topic
+// proportions theta of a document from Dirichlet(alpha) and weighs the
+// document by
+//
+//   p(w | theta) = prod_n sum_k theta_k phi_k(w_n)
+//
+// with the smoothed topic-word distributions phi of the model. The weight
+// does not depend on token order, so documents are reduced to bags of words
+// and the mixture probability of every distinct type is computed once per
+// sample and raised to its count. Documents are evaluated in parallel, each
+// from its own generator seeded with seed + document, so that estimates
+// depend on the seed only.
+class ImportanceSamplingEvaluator {
+public:
+  ImportanceSamplingEvaluator(std::size_t n_topics,
+                              const DoubleVector& alpha,
+                              double beta,
+                              const CountVector& topic_counts,
+                              const IntMatrix& type_topic_counts);
+
+  ~ImportanceSamplingEvaluator() = default;
+
+  // The seed is random unless set.
+  void set_seed(std::uint64_t seed);
+
+  // Translates the types of the evaluated corpora to the types of the model,
+  // so a corpus encoded once can be evaluated on models with other
+  // alphabets. Unmapped types are out of vocabulary and skipped.
+  void set_type_mapping(const TypeMapping& mapping);
+
+  // The log-likelihood estimate of every document of the corpus from
+  // n_samples draws of its topic proportions.
+  DoubleVector evaluate_documents(const TypeSequenceView& corpus,
+                                  std::size_t n_samples,
+                                  std::size_t n_threads) const;
+
+  double evaluate(const BagOfWords& document, std::size_t n_samples, std::uint64_t seed) const;
+
+private:
+  std::size_t n_topics_;
+  std::size_t n_types_;
+  DoubleVector alpha_;
+
+  // phi_k(v) at [v * n_topics + k], so that the mixture probability of a
+  // type reads one contiguous row.
+  DoubleVector topic_words_;
+
+  std::uint64_t seed_;
+  std::unique_ptr<const TypeMapping> type_mapping_;
+
+  std::size_t model_type(std::size_t type) const;
+
+};
+
+#endif // IMPORTANCE_SAMPLING_EVALUATOR_H
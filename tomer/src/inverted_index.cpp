@@ -0,0 +1,496 @@
+#include "inverted_index.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "bag_of_words.h"
+#include "parallel.h"
+
+namespace {
+
+const char MAGIC[8] = {'T', 'O', 'M', 'E', 'R', 'I', 'I', '1'};
+const std::uint64_t ALIGNMENT = 8;
+const std::size_t DOCUMENT_GRAIN = 256;
+
+std::uint64_t align(std::uint64_t offset) {
+  return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+}
+
+std::size_t varint_size(std::uint32_t value) {
+  std::size_t size = 1;
+  while (value >= 0x80) {
+    value >>= 7;
+    ++size;
+  }
+  return size;
+}
+
+unsigned char* write_varint(unsigned char* out, std::uint32_t value) {
+  while (value >= 0x80) {
+    *out++ = static_cast<unsigned char>(value | 0x80);
+    value >>= 7;
+  }
+  *out++ = static_cast<unsigned char>(value);
+  return out;
+}
+
+// Reads a varint that must end before end and fit in 32 bits.
+std::uint32_t read_varint(const unsigned char*& in, const unsigned char* end) {
+  std::uint32_t value = 0;
+  unsigned shift = 0;
+  while (in < end && *in & 0x80) {
+    if (shift > 21)
+      throw std::runtime_error("posting list is corrupt");
+    value |= static_cast<std::uint32_t>(*in++ & 0x7f) << shift;
+    shift += 7;
+  }
+  if (in == end || (shift == 28 && *in > 0x0f))
+    throw std::runtime_error("posting list is corrupt");
+  return value | static_cast<std::uint32_t>(*in++) << shift;
+}
+
+// Whether n elements of element_size bytes starting at offset lie within the
+// first size bytes. Divides instead of multiplying so that corrupt counts
+// cannot overflow.
+bool fits(std::uint64_t offset, std::uint64_t n, std::uint64_t element_size, std::uint64_t size) {
+  return offset <= size && n <= (size - offset) / element_size;
+}
+
+std::uint64_t bitmap_words(std::uint64_t n_documents) {
+  return (n_documents + 63) / 64;
+}
+
+// Size of the intersection of two sorted lists without duplicates. With SSE2
+// every block of four documents of one list is compared against all four
+// rotations of a block of the other.
+Count count_intersection(const std::uint32_t* a, std::size_t n_a,
+                         const std::uint32_t* b, std::size_t n_b) {
+  Count count = 0;
+  std::size_t i = 0;
+  std::size_t j = 0;
+
+#ifdef __SSE2__
+  while (i + 4 <= n_a && j + 4 <= n_b) {
+    __m128i block_a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+    __m128i block_b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + j));
+
+    __m128i matches = _mm_or_si128(
+      _mm_or_si128(_mm_cmpeq_epi32(block_a, block_b),
+                   _mm_cmpeq_epi32(block_a, _mm_shuffle_epi32(block_b, _MM_SHUFFLE(0, 3, 2, 1)))),
+      _mm_or_si128(_mm_cmpeq_epi32(block_a, _mm_shuffle_epi32(block_b, _MM_SHUFFLE(1, 0, 3, 2))),
+                   _mm_cmpeq_epi32(block_a, _mm_shuffle_epi32(block_b, _MM_SHUFFLE(2, 1, 0, 3)))));
+
+    count += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(matches)));
+
+    std::uint32_t last_a = a[i + 3];
+    std::uint32_t last_b = b[j + 3];
+    if (last_a <= last_b) i += 4;
+    if (last_b <= last_a) j += 4;
+  }
+#endif
+
+  while (i < n_a && j < n_b) {
+    if (a[i] < b[j]) {
+      ++i;
+    } else if (b[j] < a[i]) {
+      ++j;
+    } else {
+      ++count;
+      ++i;
+      ++j;
+    }
+  }
+
+  return count;
+}
+
+Count count_in_bitmap(const std::uint64_t* bitmap, const std::uint32_t* documents, std::size_t n) {
+  Count count = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    count += (bitmap[documents[i] >> 6] >> (documents[i] & 63)) & 1;
+  }
+  return count;
+}
+
+Count count_bitmap_intersection(const std::uint64_t* a, const std::uint64_t* b, std::size_t n_words) {
+  Count count = 0;
+  for (std::size_t i = 0; i < n_words; ++i) {
+    count += __builtin_popcountll(a[i] & b[i]);
+  }
+  return count;
+}
+
+}
+
+const InvertedIndex::size_type InvertedIndex::BITMAP_RATIO;
+
+InvertedIndex::InvertedIndex(const TypeSequenceView& corpus, InvertedIndex::size_type n_threads)
+  : storage_{}, mapping_{nullptr}, mapping_size_{0}
+{
+  std::uint64_t n_documents = corpus.size();
+  if (n_documents > std::numeric_limits<std::uint32_t>::max())
+    throw std::overflow_error("reference corpus has too many documents for an index");
+
+  std::uint64_t n_types = 0;
+  for (auto const& entry : corpus.alphabet()) n_types = std::max<std::uint64_t>(n_types, entry.first + 1);
+
+  if (n_threads == 0) n_threads = default_n_threads();
+
+  // The distinct types of every document, without the counts of their bags.
+  std::vector<std::vector<BagOfWords::CompactType>> document_types(n_documents);
+  std::vector<BagOfWords::SlotVector> slots(n_threads);
+  std::vector<std::atomic<Count>> frequencies(n_types);
+
+  parallel_for(0, n_documents, n_threads, [&](std::size_t doc, std::size_t thread) {
+    if (slots[thread].empty()) slots[thread].assign(n_types, BagOfWords::NONE);
+
+    document_types[doc] = BagOfWords{corpus.at(doc), slots[thread]}.types();
+
+    for (auto type : document_types[doc]) frequencies[type].fetch_add(1, std::memory_order_relaxed);
+  }, DOCUMENT_GRAIN);
+
+  // Uncompressed posting lists, back to back.
+  std::vector<std::uint64_t> list_offsets(n_types + 1, 0);
+  for (std::uint64_t type = 0; type < n_types; ++type) {
+    list_offsets[type + 1] = list_offsets[type] + frequencies[type].load();
+  }
+
+  std::vector<std::uint32_t> lists(list_offsets.back());
+  std::vector<std::uint64_t> next(list_offsets.cbegin(), list_offsets.cend() - 1);
+
+  for (std::uint64_t doc = 0; doc < n_documents; ++doc) {
+    for (auto type : document_types[doc]) lists[next[type]++] = doc;
+    document_types[doc] = std::vector<BagOfWords::CompactType>{};
+  }
+
+  std::uint64_t bitmap_threshold = std::max<std::uint64_t>(1, n_documents / BITMAP_RATIO);
+
+  std::vector<std::uint64_t> postings_offsets(n_types + 1, 0);
+  std::vector<std::uint64_t> sizes(n_types);
+
+  parallel_for(0, n_types, n_threads, [&](std::size_t type, std::size_t) {
+    std::uint64_t frequency = list_offsets[type + 1] - list_offsets[type];
+
+    if (frequency >= bitmap_threshold) {
+      sizes[type] = bitmap_words(n_documents) * sizeof(std::uint64_t);
+      return;
+    }
+
+    std::uint64_t size = 0;
+    std::uint32_t previous = 0;
+    for (std::uint64_t i = list_offsets[type]; i < list_offsets[type + 1]; ++i) {
+      size += varint_size(lists[i] - previous);
+      previous = lists[i];
+    }
+    sizes[type] = size;
+  }, DOCUMENT_GRAIN);
+
+  for (std::uint64_t type = 0; type < n_types; ++type) {
+    postings_offsets[type + 1] = align(postings_offsets[type] + sizes[type]);
+  }
+
+  Header header;
+  std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.n_documents = n_documents;
+  header.n_types = n_types;
+  header.bitmap_threshold = bitmap_threshold;
+  header.document_frequencies_offset = align(sizeof(Header));
+  header.postings_offsets_offset = header.document_frequencies_offset +
+    n_types * sizeof(std::uint64_t);
+  header.postings_offset = header.postings_offsets_offset + (n_types + 1) * sizeof(std::uint64_t);
+  header.size = header.postings_offset + postings_offsets.back();
+
+  storage_.assign(header.size / sizeof(std::uint64_t), 0);
+  char* base = reinterpret_cast<char*>(storage_.data());
+
+  std::memcpy(base, &header, sizeof(Header));
+  std::memcpy(base + header.postings_offsets_offset, postings_offsets.data(),
+              postings_offsets.size() * sizeof(std::uint64_t));
+
+  std::uint64_t* document_frequencies =
+    reinterpret_cast<std::uint64_t*>(base + header.document_frequencies_offset);
+  unsigned char* postings = reinterpret_cast<unsigned char*>(base + header.postings_offset);
+
+  parallel_for(0, n_types, n_threads, [&](std::size_t type, std::size_t) {
+    std::uint64_t frequency = list_offsets[type + 1] - list_offsets[type];
+    unsigned char* out = postings + postings_offsets[type];
+
+    document_frequencies[type] = frequency;
+
+    if (frequency >= bitmap_threshold) {
+      std::uint64_t* bits = reinterpret_cast<std::uint64_t*>(out);
+      for (std::uint64_t i = list_offsets[type]; i < list_offsets[type + 1]; ++i) {
+        bits[lists[i] >> 6] |= std::uint64_t{1} << (lists[i] & 63);
+      }
+      return;
+    }
+
+    std::uint32_t previous = 0;
+    for (std::uint64_t i = list_offsets[type]; i < list_offsets[type + 1]; ++i) {
+      out = write_varint(out, lists[i] - previous);
+      previous = lists[i];
+    }
+  }, DOCUMENT_GRAIN);
+
+  attach(base);
+}
+
+InvertedIndex::InvertedIndex(void* mapping, InvertedIndex::size_type size)
+  : storage_{}, mapping_{mapping}, mapping_size_{size}
+{
+  attach(mapping);
+}
+
+InvertedIndex::~InvertedIndex() {
+  if (mapping_ != nullptr) munmap(mapping_, mapping_size_);
+}
+
+void InvertedIndex::attach(const void* base) {
+  const char* bytes = static_cast<const char*>(base);
+
+  header_ = static_cast<const Header*>(base);
+  document_frequencies_ = reinterpret_cast<const std::uint64_t*>(bytes + header_->document_frequencies_offset);
+  postings_offsets_ = reinterpret_cast<const std::uint64_t*>(bytes + header_->postings_offsets_offset);
+  postings_ = reinterpret_cast<const unsigned char*>(bytes + header_->postings_offset);
+}
+
+InvertedIndex::SPtr InvertedIndex::open(const std::string& path) {
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd == -1)
+    throw std::runtime_error("could not open index '" + path + "': " + std::strerror(errno));
+
+  struct stat st;
+  if (fstat(fd, &st) == -1 || static_cast<std::size_t>(st.st_size) < sizeof(Header)) {
+    close(fd);
+    throw std::runtime_error("'" + path + "' is not an index");
+  }
+
+  void* address = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+
+  if (address == MAP_FAILED)
+    throw std::runtime_error("could not map index '" + path + "'");
+
+  const Header* header = static_cast<const Header*>(address);
+  if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 ||
+      header->size > static_cast<std::uint64_t>(st.st_size) ||
+      !is_valid(*header, static_cast<const char*>(address))) {
+    munmap(address, st.st_size);
+    throw std::runtime_error("'" + path + "' is not an index");
+  }
+
+  return SPtr{new InvertedIndex(address, st.st_size)};
+}
+
+bool InvertedIndex::is_valid(const Header& header, const char* base) {
+  std::uint64_t size = header.size;
+  std::uint64_t n_documents = header.n_documents;
+  std::uint64_t n_types = header.n_types;
+
+  if (n_documents > std::numeric_limits<std::uint32_t>::max() || header.bitmap_threshold == 0)
+    return false;
+
+  // n_types is checked before n_types + 1 is formed.
+  if (!fits(header.document_frequencies_offset, n_types, sizeof(std::uint64_t), size) ||
+      !fits(header.postings_offsets_offset, n_types, sizeof(std::uint64_t), size) ||
+      !fits(header.postings_offsets_offset, n_types + 1, sizeof(std::uint64_t), size) ||
+      header.postings_offset > size)
+    return false;
+
+  if (header.document_frequencies_offset % ALIGNMENT != 0 ||
+      header.postings_offsets_offset % ALIGNMENT != 0 ||
+      header.postings_offset % ALIGNMENT != 0)
+    return false;
+
+  const std::uint64_t* document_frequencies =
+    reinterpret_cast<const std::uint64_t*>(base + header.document_frequencies_offset);
+  const std::uint64_t* postings_offsets =
+    reinterpret_cast<const std::uint64_t*>(base + header.postings_offsets_offset);
+  const unsigned char* postings = reinterpret_cast<const unsigned char*>(base + header.postings_offset);
+
+  for (std::uint64_t type = 0; type < n_types; ++type) {
+    if (postings_offsets[type] > postings_offsets[type + 1]) return false;
+  }
+  if (postings_offsets[n_types] > size - header.postings_offset) return false;
+
+  // Every posting list must lie within its slot and hold as many documents,
+  // in increasing order, as the frequency of its type, so that intersections
+  // need no further checks. This reads the whole index once.
+  std::uint64_t n_words = bitmap_words(n_documents);
+
+  try {
+    for (std::uint64_t type = 0; type < n_types; ++type) {
+      std::uint64_t frequency = document_frequencies[type];
+      std::uint64_t length = postings_offsets[type + 1] - postings_offsets[type];
+      const unsigned char* in = postings + postings_offsets[type];
+
+      if (frequency > n_documents) return false;
+
+      if (frequency >= header.bitmap_threshold) {
+        if (postings_offsets[type] % ALIGNMENT != 0 || n_words > length / sizeof(std::uint64_t))
+          return false;
+
+        const std::uint64_t* bits = reinterpret_cast<const std::uint64_t*>(in);
+        if (n_documents % 64 != 0 && bits[n_words - 1] >> (n_documents % 64) != 0) return false;
+
+        std::uint64_t count = 0;
+        for (std::uint64_t i = 0; i < n_words; ++i) count += __builtin_popcountll(bits[i]);
+        if (count != frequency) return false;
+        continue;
+      }
+
+      const unsigned char* end = in + length;
+      std::uint64_t doc = 0;
+
+      for (std::uint64_t i = 0; i < frequency; ++i) {
+        std::uint64_t delta = read_varint(in, end);
+        if (i > 0 && delta == 0) return false;
+        doc += delta;
+        if (doc >= n_documents) return false;
+      }
+    }
+  } catch (const std::runtime_error&) {
+    return false;
+  }
+
+  return true;
+}
+
+void InvertedIndex::save(const std::string& path) const {
+  std::ofstream out{path, std::ios::binary | std::ios::trunc};
+  out.write(reinterpret_cast<const char*>(header_), header_->size);
+
+  if (!out)
+    throw std::runtime_error("could not write index '" + path + "'");
+}
+
+InvertedIndex::size_type InvertedIndex::n_documents() const {
+  return header_->n_documents;
+}
+
+InvertedIndex::size_type InvertedIndex::n_types() const {
+  return header_->n_types;
+}
+
+InvertedIndex::size_type InvertedIndex::bytes() const {
+  return header_->size;
+}
+
+Count InvertedIndex::document_frequency(InvertedIndex::size_type type) const {
+  if (type >= n_types())
+    throw std::out_of_range("type " + std::to_string(type) + " is not in the index");
+
+  return document_frequencies_[type];
+}
+
+Count InvertedIndex::co_document_frequency(InvertedIndex::size_type first,
+                                           InvertedIndex::size_type second) const {
+  DocumentVector first_documents;
+  DocumentVector second_documents;
+  return co_document_frequency(first, second, first_documents, second_documents);
+}
+
+CountVector InvertedIndex::co_document_frequencies(const std::vector<InvertedIndex::size_type>& first,
+                                                   const std::vector<InvertedIndex::size_type>& second,
+                                                   InvertedIndex::size_type n_threads) const {
+  if (first.size() != second.size())
+    throw std::invalid_argument("pairs need as many first as second types");
+
+  if (n_threads == 0) n_threads = default_n_threads();
+
+  CountVector frequencies(first.size());
+  std::vector<DocumentVector> scratch(2 * n_threads);
+
+  parallel_for(0, first.size(), n_threads, [&](std::size_t pair, std::size_t thread) {
+    frequencies[pair] = co_document_frequency(first[pair],
+                                              second[pair],
+                                              scratch[2 * thread],
+                                              scratch[2 * thread + 1]);
+  });
+
+  return frequencies;
+}
+
+InvertedIndex::DocumentVector InvertedIndex::documents(InvertedIndex::size_type type) const {
+  if (type >= n_types())
+    throw std::out_of_range("type " + std::to_string(type) + " is not in the index");
+
+  DocumentVector documents;
+
+  if (!is_bitmap(type)) {
+    decode(type, documents);
+    return documents;
+  }
+
+  const std::uint64_t* bits = bitmap(type);
+  documents.reserve(document_frequencies_[type]);
+  for (std::uint64_t doc = 0; doc < n_documents(); ++doc) {
+    if ((bits[doc >> 6] >> (doc & 63)) & 1) documents.push_back(doc);
+  }
+
+  return documents;
+}
+
+bool InvertedIndex::is_bitmap(InvertedIndex::size_type type) const {
+  return document_frequencies_[type] >= header_->bitmap_threshold;
+}
+
+const std::uint64_t* InvertedIndex::bitmap(InvertedIndex::size_type type) const {
+  return reinterpret_cast<const std::uint64_t*>(postings_ + postings_offsets_[type]);
+}
+
+void InvertedIndex::decode(InvertedIndex::size_type type, InvertedIndex::DocumentVector& documents) const {
+  const unsigned char* in = postings_ + postings_offsets_[type];
+  const unsigned char* end = postings_ + postings_offsets_[type + 1];
+  std::uint64_t frequency = document_frequencies_[type];
+
+  documents.resize(frequency);
+
+  std::uint32_t doc = 0;
+  for (std::uint64_t i = 0; i < frequency; ++i) {
+    doc += read_varint(in, end);
+    documents[i] = doc;
+  }
+}
+
+Count InvertedIndex::co_document_frequency(InvertedIndex::size_type first,
+                                           InvertedIndex::size_type second,
+                                           InvertedIndex::DocumentVector& first_documents,
+                                           InvertedIndex::DocumentVector& second_documents) const {
+  if (first >= n_types() || second >= n_types())
+    throw std::out_of_range("type is not in the index");
+
+  bool first_bitmap = is_bitmap(first);
+  bool second_bitmap = is_bitmap(second);
+
+  if (first_bitmap && second_bitmap)
+    return count_bitmap_intersection(bitmap(first), bitmap(second), bitmap_words(n_documents()));
+
+  if (first_bitmap || second_bitmap) {
+    size_type list = first_bitmap ? second : first;
+    decode(list, first_documents);
+    return count_in_bitmap(bitmap(first_bitmap ? first : second),
+                           first_documents.data(),
+                           first_documents.size());
+  }
+
+  decode(first, first_documents);
+  decode(second, second_documents);
+
+  return count_intersection(first_documents.data(), first_documents.size(),
+                            second_documents.data(), second_documents.size());
+}
@@ -0,0 +1,92 @@
+#ifndef INVERTED_INDEX_H
+#define INVERTED_INDEX_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "def.h"
+#include "type_sequence_view.h"
+
+// The documents every type of a reference corpus occurs in, for counting
+// document (co-)frequencies when measuring coherence. The posting list of a
+// type is stored either as delta-coded varints or, for types occurring in at
+// least one in BITMAP_RATIO documents, as a bitmap over all documents.
+//
+// Like FrontCodedDictionary, the index is one contiguous buffer that is built
+// once, saved, and mapped back into memory without parsing.
+class InvertedIndex {
+public:
+  using SPtr = std::shared_ptr<const InvertedIndex>;
+  using size_type = std::size_t;
+  using DocumentVector = std::vector<std::uint32_t>;
+
+  static const size_type BITMAP_RATIO = 16;
+
+  InvertedIndex(const TypeSequenceView& corpus, size_type n_threads);
+  ~InvertedIndex();
+
+  static SPtr open(const std::string& path);
+  void save(const std::string& path) const;
+
+  size_type n_documents() const;
+  size_type n_types() const;
+
+  // Size of the index in bytes.
+  size_type bytes() const;
+
+  Count document_frequency(size_type type) const;
+  Count co_document_frequency(size_type first, size_type second) const;
+
+  // Co-document frequencies of the pairs (first[i], second[i]).
+  CountVector co_document_frequencies(const std::vector<size_type>& first,
+                                      const std::vector<size_type>& second,
+                                      size_type n_threads) const;
+
+  DocumentVector documents(size_type type) const;
+
+private:
+  struct Header {
+    char magic[8];
+    std::uint64_t n_documents;
+    std::uint64_t n_types;
+    std::uint64_t bitmap_threshold;
+    std::uint64_t document_frequencies_offset;
+    std::uint64_t postings_offsets_offset;
+    std::uint64_t postings_offset;
+    std::uint64_t size;
+  };
+
+  std::vector<std::uint64_t> storage_;
+  void* mapping_;
+  size_type mapping_size_;
+
+  const Header* header_;
+  const std::uint64_t* document_frequencies_;
+  const std::uint64_t* postings_offsets_;
+  const unsigned char* postings_;
+
+  InvertedIndex(void* mapping, size_type size);
+
+  void attach(const void* base);
+
+  // Whether every section of the header lies within its size, which open
+  // has checked against the mapped size, and every posting list decodes.
+  static bool is_valid(const Header& header, const char* base);
+
+  bool is_bitmap(size_type type) const;
+  const std::uint64_t* bitmap(size_type type) const;
+  void decode(size_type type, DocumentVector& documents) const;
+
+  Count co_document_frequency(size_type first,
+                              size_type second,
+                              DocumentVector& first_documents,
+                              DocumentVector& second_documents) const;
+
+  InvertedIndex(const InvertedIndex& other) = delete;
+  InvertedIndex& operator=(const InvertedIndex& rhs) = delete;
+
+};
+
+#endif // INVERTED_INDEX_H
@@ -0,0 +1,180 @@
+#include "joint_likelihood.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+#include "parallel.h"
+
+namespace {
+
+// Documents and types are summed in blocks of fixed size, and the block
+// sums in block order, so that the result does not depend on the number of
+// threads or on how the blocks were scheduled.
+const std::size_t DOCUMENT_BLOCK = 256;
+const std::size_t TYPE_BLOCK = 256;
+
+std::size_t n_blocks(std::size_t n, std::size_t block) {
+  return (n + block - 1) / block;
+}
+
+}
+
+const Count JointLikelihood::ALPHA_TABLE_SIZE;
+const Count JointLikelihood::BETA_TABLE_SIZE;
+const Count JointLikelihood::LENGTH_TABLE_SIZE;
+
+JointLikelihood::JointLikelihood(std::size_t n_topics, const DoubleVector& alpha, double beta)
+  : n_topics_{n_topics}, alpha_{alpha}, alpha_sum_{0}, beta_{beta},
+    alpha_table_(n_topics * ALPHA_TABLE_SIZE), beta_table_(BETA_TABLE_SIZE), length_table_(LENGTH_TABLE_SIZE)
+{
+  if (alpha_.size() != n_topics)
+    throw std::invalid_argument("alpha needs one element per topic");
+
+  if (std::any_of(alpha_.cbegin(), alpha_.cend(), [](double a) { return !(a > 0); }) || !(beta_ > 0))
+    throw std::invalid_argument("alpha and beta must be positive");
+
+  alpha_sum_ = std::accumulate(alpha_.cbegin(), alpha_.cend(), 0.0);
+
+  for (std::size_t topic = 0; topic < n_topics_; ++topic) {
+    double offset = std::lgamma(alpha_[topic]);
+    for (Count n = 0; n < ALPHA_TABLE_SIZE; ++n) {
+      alpha_table_[topic * ALPHA_TABLE_SIZE + n] = std::lgamma(alpha_[topic] + n) - offset;
+    }
+  }
+
+  double offset = std::lgamma(beta_);
+  for (Count n = 0; n < BETA_TABLE_SIZE; ++n) {
+    beta_table_[n] = std::lgamma(beta_ + n) - offset;
+  }
+
+  for (Count n = 0; n < LENGTH_TABLE_SIZE; ++n) {
+    length_table_[n] = std::lgamma(alpha_sum_ + n);
+  }
+}
+
+double JointLikelihood::alpha_term(std::size_t topic, Count count) const {
+  if (count < ALPHA_TABLE_SIZE) return alpha_table_[topic * ALPHA_TABLE_SIZE + count];
+  return std::lgamma(alpha_[topic] + count) - std::lgamma(alpha_[topic]);
+}
+
+double JointLikelihood::beta_term(Count count) const {
+  if (count < BETA_TABLE_SIZE) return beta_table_[count];
+  return std::lgamma(beta_ + count) - std::lgamma(beta_);
+}
+
+double JointLikelihood::length_term(Count length) const {
+  if (length < LENGTH_TABLE_SIZE) return length_table_[length];
+  return std::lgamma(alpha_sum_ + length);
+}
+
+JointLikelihood::Result JointLikelihood::compute(const IntVector& docs,
+                                                 const IntVector& topics,
+                                                 std::size_t n_docs,
+                                                 const CountVector& topic_counts,
+                                                 const IntMatrix& type_topic_counts,
+                                                 std::size_t n_threads) const {
+  Result result;
+  result.topic_log_likelihood = topic_log_likelihood(docs, topics, n_docs, n_threads);
+  result.word_log_likelihood = word_log_likelihood(topic_counts, type_topic_counts, n_threads);
+  result.log_likelihood = result.topic_log_likelihood + result.word_log_likelihood;
+  return result;
+}
+
+double JointLikelihood::topic_log_likelihood(const IntVector& docs,
+                                             const IntVector& topics,
+                                             std::size_t n_docs,
+                                             std::size_t n_threads) const {
+  if (docs.size() != topics.size())
+    throw std::invalid_argument("every token needs a document and a topic");
+
+  std::size_t n_tokens = docs.size();
+
+  // Tokens are grouped by document with a counting sort, unless they already
+  // are, as in states written by MALLET.
+  std::vector<std::size_t> offsets(n_docs + 1, 0);
+  bool grouped = true;
+
+  for (std::size_t i = 0; i < n_tokens; ++i) {
+    if (docs[i] >= n_docs)
+      throw std::out_of_range("document " + std::to_string(docs[i]) + " is out of range");
+    if (topics[i] >= n_topics_)
+      throw std::out_of_range("topic " + std::to_string(topics[i]) + " is out of range");
+    if (i > 0 && docs[i] < docs[i - 1]) grouped = false;
+
+    ++offsets[docs[i] + 1];
+  }
+
+  std::partial_sum(offsets.cbegin(), offsets.cend(), offsets.begin());
+
+  IntVector sorted_topics;
+  if (!grouped) {
+    sorted_topics.resize(n_tokens);
+    std::vector<std::size_t> next(offsets.cbegin(), offsets.cend() - 1);
+    for (std::size_t i = 0; i < n_tokens; ++i) sorted_topics[next[docs[i]]++] = topics[i];
+  }
+
+  const IntVector& doc_topics = grouped ? topics : sorted_topics;
+
+  if (n_threads == 0) n_threads = default_n_threads();
+
+  std::vector<IntVector> counts(n_threads);
+  std::vector<IntVector> touched(n_threads);
+  DoubleVector sums(n_blocks(n_docs, DOCUMENT_BLOCK), 0.0);
+
+  parallel_for(0, sums.size(), n_threads, [&](std::size_t block, std::size_t thread) {
+    IntVector& count = counts[thread];
+    IntVector& seen = touched[thread];
+    if (count.empty()) count.assign(n_topics_, 0);
+
+    std::size_t end = std::min(n_docs, (block + 1) * DOCUMENT_BLOCK);
+    for (std::size_t doc = block * DOCUMENT_BLOCK; doc < end; ++doc) {
+      for (std::size_t i = offsets[doc]; i < offsets[doc + 1]; ++i) {
+        if (count[doc_topics[i]]++ == 0) seen.push_back(doc_topics[i]);
+      }
+
+      double sum = length_term(0) - length_term(offsets[doc + 1] - offsets[doc]);
+      for (auto topic : seen) {
+        sum += alpha_term(topic, count[topic]);
+        count[topic] = 0;
+      }
+      seen.clear();
+
+      sums[block] += sum;
+    }
+  });
+
+  return std::accumulate(sums.cbegin(), sums.cend(), 0.0);
+}
+
+double JointLikelihood::word_log_likelihood(const CountVector& topic_counts,
+                                            const IntMatrix& type_topic_counts,
+                                            std::size_t n_threads) const {
+  if (topic_counts.size() != n_topics_)
+    throw std::invalid_argument("topic counts need one element per topic");
+
+  std::size_t n_types = type_topic_counts.size();
+  double beta_sum = n_types * beta_;
+
+  double sum = 0;
+  for (std::size_t topic = 0; topic < n_topics_; ++topic) {
+    sum += std::lgamma(beta_sum) - std::lgamma(beta_sum + topic_counts[topic]);
+  }
+
+  DoubleVector sums(n_blocks(n_types, TYPE_BLOCK), 0.0);
+
+  parallel_for(0, sums.size(), n_threads, [&](std::size_t block, std::size_t) {
+    std::size_t end = std::min(n_types, (block + 1) * TYPE_BLOCK);
+    for (std::size_t type = block * TYPE_BLOCK; type < end; ++type) {
+      double type_sum = 0;
+      for (auto count : type_topic_counts[type]) {
+        if (count > 0) type_sum += beta_term(count);
+      }
+      sums[block] += type_sum;
+    }
+  });
+
+  return sum + std::accumulate(sums.cbegin(), sums.cend(), 0.0);
+}
@@ -0,0 +1,78 @@
+#ifndef JOINT_LIKELIHOOD_H
+#define JOINT_LIKELIHOOD_H
+
+#include <vector>
+
+#include "def.h"
+
+// The joint log-likelihood log p(w, z) of a Gibbs state under LDA with the
+// topic proportions and topics integrated out, the quantity MALLET reports
+// while training. It splits into
+//
+//   log p(z)     = sum_d [ lgamma(A) - lgamma(A + n_d)
+//                          + sum_k lgamma(alpha_k + n_dk) - lgamma(alpha_k) ]
+//   log p(w | z) = sum_k [ lgamma(V beta) - lgamma(V beta + n_k)
+//                          + sum_v lgamma(beta + n_vk) - lgamma(beta) ]
+//
+// where A is the sum of alpha. Only nonzero counts contribute to the inner
+// sums, and almost all of them are small, so lgamma differences of counts
+// below the table sizes are looked up instead of computed. Documents and
+// types are summed in fixed blocks whose sums are added in order, so the
+// result is the same for any number of threads.
+class JointLikelihood {
+public:
+  struct Result {
+    double log_likelihood;
+    double topic_log_likelihood;
+    double word_log_likelihood;
+  };
+
+  static const Count ALPHA_TABLE_SIZE = 256;
+  static const Count BETA_TABLE_SIZE = 4096;
+  // Document lengths are mostly longer than type-topic counts.
+  static const Count LENGTH_TABLE_SIZE = 8192;
+
+  // Every element of alpha and beta must be positive.
+  JointLikelihood(std::size_t n_topics, const DoubleVector& alpha, double beta);
+
+  ~JointLikelihood() = default;
+
+  // Takes the document and topic of every token, documents numbered
+  // 0, ..., n_docs - 1, and the topic sizes and dense type-topic counts the
+  // left-to-right evaluator uses. Documents and types are scored in
+  // parallel.
+  Result compute(const IntVector& docs,
+                 const IntVector& topics,
+                 std::size_t n_docs,
+                 const CountVector& topic_counts,
+                 const IntMatrix& type_topic_counts,
+                 std::size_t n_threads) const;
+
+  double topic_log_likelihood(const IntVector& docs,
+                              const IntVector& topics,
+                              std::size_t n_docs,
+                              std::size_t n_threads) const;
+
+  double word_log_likelihood(const CountVector& topic_counts,
+                             const IntMatrix& type_topic_counts,
+                             std::size_t n_threads) const;
+
+private:
+  std::size_t n_topics_;
+  DoubleVector alpha_;
+  double alpha_sum_;
+  double beta_;
+
+  // lgamma(alpha_k + n) - lgamma(alpha_k) by topic and n,
+  // lgamma(beta + n) - lgamma(beta) and lgamma(A + n) by n.
+  DoubleVector alpha_table_;
+  DoubleVector beta_table_;
+  DoubleVector length_table_;
+
+  double alpha_term(std::size_t topic, Count count) const;
+  double beta_term(Count count) const;
+  double length_term(Count length) const;
+
+};
+
+#endif // JOINT_LIKELIHOOD_H
@@ -3,152 +3,729 @@
 #include <iostream>
 #include <cmath>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+
+#include "parallel.h"
+
+namespace {
+
+// Documents handed to a thread at a time in interleaved evaluation; their
+// particles are spread over its lanes.
+const std::size_t INTERLEAVED_DOCUMENT_GRAIN = 16;
+
+const std::uint64_t GOLDEN_GAMMA = 0x9e3779b97f4a7c15ULL;
+
+inline void prefetch(const void* address) {
+#if defined(__GNUC__)
+  __builtin_prefetch(address);
+#endif
+}
+
+// The finalizer of SplitMix64.
+inline std::uint64_t mix(std::uint64_t z) {
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+inline std::uint64_t particle_stream(std::uint64_t seed, std::size_t doc, std::size_t particle) {
+  return mix(mix(seed + (doc + 1) * GOLDEN_GAMMA) + (particle + 1) * GOLDEN_GAMMA);
+}
+
+// The uniform in [0, 1) a particle draws for the token at position once the
+// tokens before limit have been evaluated. A particle draws at most once per
+// limit and position, so numbering the draws in the order a run with
+// resampling makes them gives every draw its own element of a SplitMix64
+// sequence, which is computed directly instead of after all the ones before.
+inline double draw_uniform(std::uint64_t stream, std::size_t limit, std::size_t position) {
+  std::uint64_t counter = static_cast<std::uint64_t>(limit) * (limit + 1) / 2 + position;
+  return (mix(stream + (counter + 1) * GOLDEN_GAMMA) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+}
 
 LeftToRightEvaluator::LeftToRightEvaluator(std::size_t n_topics,
                                            const DoubleVector& alpha,
                                            double beta,
-                                           const IntVector& topic_counts,
+                                           const CountVector& topic_counts,
                                            const IntMatrix& type_topic_counts)
   : n_topics_{n_topics},
+    n_types_{type_topic_counts.size()},
     alpha_{alpha},
     beta_{beta},
-    topic_counts_{topic_counts},
-    type_topic_counts_{type_topic_counts},
+    topic_counts_storage_{topic_counts},
+    type_topic_counts_storage_(type_topic_counts.size() * n_topics),
+    shared_model_{},
     cached_coefficients_(n_topics),
     smoothing_only_mass_{0},
-    sampler_{}
+    n_threads_{1},
+    n_lanes_{1},
+    placement_{NumaPlacement::NONE},
+    seed_{std::random_device{}()},
+    topic_counts_replicas_{},
+    type_topic_counts_replicas_{},
+    interleaved_{false},
+    workers_{},
+    diagnostics_{false},
+    type_mapping_{}
 {
-  alpha_sum_ = std::accumulate(alpha.cbegin(), alpha.cend(), 0.0);
-  beta_sum_ = n_topics * beta;
+  for (std::size_t type = 0; type < n_types_; ++type) {
+    std::copy(type_topic_counts.at(type).cbegin(),
+              type_topic_counts.at(type).cend(),
+              type_topic_counts_storage_.begin() + type * n_topics_);
+  }
+
+  topic_counts_ = topic_counts_storage_.data();
+  type_topic_counts_ = type_topic_counts_storage_.data();
+
+  initialize_coefficients();
+  prepare_workers(n_threads_);
+}
+
+LeftToRightEvaluator::LeftToRightEvaluator(SharedModel::SPtr model)
+  : n_topics_{model->n_topics()},
+    n_types_{model->n_types()},
+    alpha_(model->alpha(), model->alpha() + model->n_topics()),
+    beta_{model->beta()},
+    topic_counts_storage_{},
+    type_topic_counts_storage_{},
+    shared_model_{model},
+    topic_counts_{model->topic_counts()},
+    type_topic_counts_{model->type_topic_counts()},
+    cached_coefficients_(model->n_topics()),
+    smoothing_only_mass_{0},
+    n_threads_{1},
+    n_lanes_{1},
+    placement_{NumaPlacement::NONE},
+    seed_{std::random_device{}()},
+    topic_counts_replicas_{},
+    type_topic_counts_replicas_{},
+    interleaved_{false},
+    workers_{},
+    diagnostics_{false},
+    type_mapping_{}
+{
+  initialize_coefficients();
+  prepare_workers(n_threads_);
+}
 
-  for (unsigned topic = 0; topic < n_topics_; ++topic) {
-    double denom = (topic_counts_.at(topic) + beta_sum_);
+void LeftToRightEvaluator::initialize_coefficients() {
+  alpha_sum_ = std::accumulate(alpha_.cbegin(), alpha_.cend(), 0.0);
+  beta_sum_ = n_topics_ * beta_;
+
+  for (std::size_t topic = 0; topic < n_topics_; ++topic) {
+    double denom = (topic_counts_[topic] + beta_sum_);
     smoothing_only_mass_ += alpha_.at(topic) * beta_ / denom;
     cached_coefficients_.at(topic) = alpha_.at(topic) / denom;
   }
 }
 
+void LeftToRightEvaluator::set_parallelism(std::size_t n_threads, NumaPlacement placement) {
+  n_threads_ = n_threads == 0 ? default_n_threads() : n_threads;
+  placement_ = placement;
+
+  prepare_workers(n_threads_ * n_lanes_);
+  place_model();
+}
+
+void LeftToRightEvaluator::set_interleaving(std::size_t n_lanes) {
+  n_lanes_ = std::max<std::size_t>(n_lanes, 1);
+
+  prepare_workers(n_threads_ * n_lanes_);
+  place_model();
+}
+
+void LeftToRightEvaluator::set_seed(std::uint64_t seed) {
+  seed_ = seed;
+}
+
+void LeftToRightEvaluator::place_model() {
+  const NumaTopology& topology = NumaTopology::get();
+  std::size_t n_nodes = topology.n_nodes();
+
+  topic_counts_replicas_.clear();
+  type_topic_counts_replicas_.clear();
+
+  if (placement_ == NumaPlacement::REPLICATE && n_nodes > 1) {
+    topic_counts_replicas_.resize(n_nodes);
+    type_topic_counts_replicas_.resize(n_nodes);
+
+    // Every replica is allocated and filled by a thread bound to its node so
+    // that the pages are placed there on first touch.
+    parallel_for(0, n_nodes, n_nodes, [&](std::size_t node, std::size_t) {
+      AffinityGuard guard;
+      bind_to_node(node);
+
+      topic_counts_replicas_[node] = CountVector(topic_counts_, topic_counts_ + n_topics_);
+      type_topic_counts_replicas_[node] = IntVector(type_topic_counts_,
+                                                    type_topic_counts_ + n_types_ * n_topics_);
+    });
+  }
+
+  // Only the evaluator's own counts are interleaved: changing the policy of a
+  // shared model would move pages under the other processes that map it.
+  if (placement_ == NumaPlacement::INTERLEAVE && !interleaved_ && !shared_model_) {
+    interleaved_ = interleave_pages(type_topic_counts_storage_.data(),
+                                    type_topic_counts_storage_.size() * sizeof(uint));
+  }
+
+  for (std::size_t i = 0; i < workers_.size(); ++i) {
+    Worker& worker = *workers_[i];
+    std::size_t node = (i / n_lanes_) % n_nodes;
+
+    worker.topic_counts = topic_counts_replicas_.empty() ?
+      topic_counts_ : topic_counts_replicas_[node].data();
+    worker.type_topic_counts = type_topic_counts_replicas_.empty() ?
+      type_topic_counts_ : type_topic_counts_replicas_[node].data();
+  }
+}
+
+void LeftToRightEvaluator::prepare_workers(std::size_t n_workers) {
+  while (workers_.size() < n_workers) {
+    std::unique_ptr<Worker> worker{new Worker};
+    worker->cached_coefficients = cached_coefficients_;
+    worker->topic_counts = topic_counts_;
+    worker->type_topic_counts = type_topic_counts_;
+    workers_.push_back(std::move(worker));
+  }
+}
+
+void LeftToRightEvaluator::set_type_mapping(const TypeMapping& mapping) {
+  type_mapping_.reset(new TypeMapping{mapping});
+}
+
+void LeftToRightEvaluator::set_diagnostics(bool enabled) {
+  diagnostics_ = enabled;
+
+  if (enabled) {
+    for (auto& worker : workers_) worker->diagnostics.clear();
+  }
+}
+
+TypeDiagnostics LeftToRightEvaluator::diagnostics() const {
+  TypeDiagnostics diagnostics;
+
+  for (auto const& worker : workers_) {
+    for (auto const& entry : worker->diagnostics) {
+      TypeDiagnostic& diagnostic = diagnostics.insert(
+        std::make_pair(entry.first, TypeDiagnostic{0.0, 0})).first->second;
+
+      diagnostic.log_probability += entry.second.log_probability;
+      diagnostic.n_tokens += entry.second.n_tokens;
+    }
+  }
+
+  return diagnostics;
+}
+
+const uint* LeftToRightEvaluator::type_topic_counts_at(const Worker& worker,
+                                                       std::size_t type) const {
+  return worker.type_topic_counts + type * n_topics_;
+}
+
+LeftToRightEvaluator::Worker& LeftToRightEvaluator::thread_worker(std::size_t thread) {
+  return *workers_[thread * n_lanes_];
+}
+
+template <typename Function>
+void LeftToRightEvaluator::parallel_for_on_nodes(std::size_t begin, std::size_t end, Function f) {
+  std::size_t n_nodes = NumaTopology::get().n_nodes();
+  bool bind = placement_ != NumaPlacement::NONE && n_nodes > 1;
+  std::vector<char> bound(n_threads_, 0);
+
+  // The calling thread takes part as thread 0.
+  AffinityGuard guard;
+
+  parallel_for(begin, end, n_threads_, [&](std::size_t i, std::size_t thread) {
+    if (bind && !bound[thread]) {
+      bind_to_node(thread % n_nodes);
+      bound[thread] = 1;
+    }
+
+    f(i, thread);
+  });
+}
+
+// Unmapped types are beyond every model and thus skipped like any other type
+// the model does not know.
+std::size_t LeftToRightEvaluator::model_type(std::size_t type) const {
+  return type_mapping_ ? type_mapping_->at(type) : type;
+}
+
 double LeftToRightEvaluator::evaluate(const CorpusTypeSequence& types,
                                       std::size_t n_particles,
                                       bool resampling) {
-  DoubleMatrix particle_probabilities(n_particles);
+  DoubleVector doc_log_likelihood = evaluate_documents(types, n_particles, resampling);
+  return std::accumulate(doc_log_likelihood.cbegin(), doc_log_likelihood.cend(), 0.0);
+}
 
-  double total_log_likelihood = 0;
-  double log_n_particles = log(n_particles);
-  double doc_log_likelihood, log_prob, sum;
-  std::size_t max_len = 0;
+DoubleVector LeftToRightEvaluator::evaluate_documents(const CorpusTypeSequence& types,
+                                                      std::size_t n_particles,
+                                                      bool resampling) {
+  if (n_lanes_ > 1) return evaluate_interleaved(types, n_particles, resampling);
 
-  for (unsigned i = 0; i < types.size(); ++i) {
-    doc_log_likelihood = 0;
+  std::size_t n_docs = types.size();
+  DoubleVector doc_log_likelihood(n_docs);
 
-    for (unsigned particle = 0; particle < n_particles; ++particle) {
-      particle_probabilities.at(particle) = get_word_probabilities(types.at(i), resampling);
-      max_len = std::max(max_len,  particle_probabilities.at(particle).size());
-    }
+  parallel_for_on_nodes(0, n_docs, [&](std::size_t doc, std::size_t thread) {
+    DocumentState state;
+    doc_log_likelihood[doc] = evaluate(types.at(doc), n_particles, resampling, state, doc,
+                                       thread_worker(thread));
+  });
 
-    for (unsigned position = 0; position < max_len; ++position) {
-      sum = 0;
+  return doc_log_likelihood;
+}
 
-      for (unsigned particle = 0; particle < n_particles; ++particle) {
-        if (position >= particle_probabilities.at(particle).size()) break;
+// Every thread takes a few documents at a time and keeps its lanes busy with
+// their particles. After a lane has advanced by a token, the model row of its
+// next token is prefetched, and it is not needed before all other lanes have
+// advanced as well.
+DoubleVector LeftToRightEvaluator::evaluate_interleaved(const CorpusTypeSequence& types,
+                                                        std::size_t n_particles,
+                                                        bool resampling) {
+  std::size_t n_docs = types.size();
+  std::size_t n_groups = (n_docs + INTERLEAVED_DOCUMENT_GRAIN - 1) / INTERLEAVED_DOCUMENT_GRAIN;
+
+  DoubleVector doc_log_likelihood(n_docs, 0.0);
+
+  parallel_for_on_nodes(0, n_groups, [&](std::size_t group, std::size_t thread) {
+    std::size_t first = group * INTERLEAVED_DOCUMENT_GRAIN;
+    std::size_t n_group_docs = std::min(INTERLEAVED_DOCUMENT_GRAIN, n_docs - first);
+    std::size_t n_units = n_group_docs * n_particles;
+    std::size_t next_unit = 0;
+
+    std::vector<DoubleMatrix> particle_probabilities(n_group_docs, DoubleMatrix(n_particles));
+    std::vector<std::size_t> remaining(n_group_docs, n_particles);
+    std::vector<std::unique_ptr<Lane>> lanes(n_lanes_);
+    std::size_t n_active = 0;
+
+    auto prefetch_next = [&](const Lane& lane) {
+      std::size_t type = model_type(lane.types.at(lane.position));
+      if (type < n_types_) prefetch(type_topic_counts_at(*lane.state.worker, type));
+    };
+
+    // Starts the next particle in a lane, skipping those of empty documents.
+    auto refill = [&](std::size_t l) {
+      lanes[l].reset();
+
+      while (next_unit < n_units) {
+        std::size_t doc = first + next_unit / n_particles;
+        std::size_t index = next_unit++ % n_particles;
+        std::unique_ptr<Lane> lane{new Lane{types.at(doc)}};
+        ParticleState particle;
+
+        lane->doc = doc;
+        lane->index = index;
+        start_lane(*lane, particle, index, 0, resampling, *workers_[thread * n_lanes_ + l]);
+
+        if (!is_finished(*lane)) {
+          prefetch_next(*lane);
+          lanes[l] = std::move(lane);
+          ++n_active;
+          return;
+        }
 
-        sum += particle_probabilities.at(particle).at(position);
+        finish_lane(*lane, particle);
       }
+    };
+
+    // The particles of a document finish in any order, so their word
+    // probabilities are kept until the last one has and then combined in
+    // the order of the particles.
+    auto complete = [&](Lane& lane) {
+      std::size_t i = lane.doc - first;
+      particle_probabilities[i][lane.index] = std::move(lane.word_probabilities);
+
+      if (--remaining[i] > 0) return;
+
+      doc_log_likelihood[lane.doc] = combine_particles(lane.types, 0, particle_probabilities[i],
+                                                       *lane.state.worker);
+      DoubleMatrix{}.swap(particle_probabilities[i]);
+    };
+
+    for (std::size_t l = 0; l < n_lanes_; ++l) refill(l);
+
+    while (n_active > 0) {
+      for (std::size_t l = 0; l < n_lanes_; ++l) {
+        Lane* lane = lanes[l].get();
+        if (!lane) continue;
+
+        step(*lane, resampling);
+
+        if (!is_finished(*lane)) {
+          prefetch_next(*lane);
+          continue;
+        }
 
-      if (sum > 0) {
-        log_prob = log(sum) - log_n_particles;
-        doc_log_likelihood += log_prob;
+        ParticleState particle;
+        finish_lane(*lane, particle);
+        complete(*lane);
+
+        --n_active;
+        refill(l);
       }
     }
+  });
 
-    total_log_likelihood += doc_log_likelihood;
-  }
+  return doc_log_likelihood;
+}
 
-  return total_log_likelihood;
+double LeftToRightEvaluator::evaluate(const DocumentTypeSequence& types,
+                                      std::size_t n_particles,
+                                      bool resampling,
+                                      DocumentState& state,
+                                      std::size_t doc) {
+  return evaluate(types, n_particles, resampling, state, doc, *workers_.front());
 }
 
-DoubleVector LeftToRightEvaluator::get_word_probabilities(const DocumentTypeSequence& types,
-                                                          bool resampling) {
+LeftToRightEvaluator::AnytimeResult LeftToRightEvaluator::evaluate_anytime(const CorpusTypeSequence& types,
+                                                                           std::size_t n_particles,
+                                                                           bool resampling,
+                                                                           double seconds) {
+  using Clock = std::chrono::steady_clock;
 
-  uint doc_length = types.length();
-  int type, old_topic, new_topic, topic;
-  uint tokens_so_far = 0;
+  Clock::time_point started = Clock::now();
+  Clock::time_point deadline = started +
+    std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
 
-  DoubleVector word_probabilities(doc_length);
+  std::size_t n_docs = types.size();
 
-  LocalState state;
+  std::vector<std::size_t> order(n_docs);
+  std::iota(order.begin(), order.end(), 0);
+  std::mt19937_64 gen{seed_};
+  std::shuffle(order.begin(), order.end(), gen);
 
-  state.doc_topics = IntVector(doc_length);
-  state.topic_counts = IntVector(n_topics_);
-  state.topic_index = IntVector(n_topics_);
+  std::vector<AnytimeDocument> documents(n_docs);
+  std::atomic<bool> expired{false};
 
-  state.dense_index = 0;
-  state.non_zero_topics = 0;
+  for (std::size_t pass = 0; pass < n_particles && !expired; ++pass) {
+    parallel_for_on_nodes(0, n_docs, [&](std::size_t i, std::size_t thread) {
+      if (expired.load(std::memory_order_relaxed)) return;
 
-  state.topic_beta_mass = 0.0;
-  state.topic_term_mass = 0.0;
+      if (Clock::now() >= deadline) {
+        expired = true;
+        return;
+      }
 
-  state.topic_term_scores = DoubleVector(n_topics_);
+      std::size_t doc = order[i];
+      add_particle(types.at(doc), resampling, documents[doc], doc, thread_worker(thread));
+    });
+  }
+
+  AnytimeResult result;
+  result.n_docs = n_docs;
+  result.n_docs_evaluated = 0;
+  result.n_tokens = 0;
+  result.n_tokens_evaluated = 0;
+  result.min_particles = n_particles;
+  result.n_evaluations = 0;
+
+  double log_likelihood = 0;
+  double particle_variance = 0;
+  DoubleVector doc_log_likelihoods;
+  DoubleVector doc_lengths;
+
+  for (std::size_t doc = 0; doc < n_docs; ++doc) {
+    const AnytimeDocument& document = documents[doc];
+    std::size_t length = types.at(doc).length();
+
+    result.n_tokens += length;
+    result.min_particles = std::min(result.min_particles, document.n_particles);
+    result.n_evaluations += document.n_particles;
+
+    if (document.n_particles == 0) continue;
+
+    double doc_log_likelihood = 0;
+    double log_n_particles = log(document.n_particles);
+
+    for (double sum : document.probability_sums) {
+      if (sum > 0) doc_log_likelihood += log(sum) - log_n_particles;
+    }
+
+    ++result.n_docs_evaluated;
+    result.n_tokens_evaluated += length;
+    log_likelihood += doc_log_likelihood;
+    doc_log_likelihoods.push_back(doc_log_likelihood);
+    doc_lengths.push_back(length);
+
+    if (document.n_particles > 1) {
+      double mean = document.log_likelihood_sum / document.n_particles;
+      double variance = (document.log_likelihood_squares - document.n_particles * mean * mean) /
+        (document.n_particles - 1);
+      particle_variance += std::max(variance, 0.0) / document.n_particles;
+    }
+  }
 
-  for (unsigned limit = 0; limit < doc_length; ++limit) {
-    if (resampling) {
-      for (unsigned position = 0; position < limit; ++position) {
-        type = types.at(position);
+  std::size_t n_evaluated = result.n_docs_evaluated;
+  double sampling_variance = 0;
+
+  if (n_evaluated == 0 && n_docs > 0) {
+    log_likelihood = std::numeric_limits<double>::quiet_NaN();
+    sampling_variance = std::numeric_limits<double>::quiet_NaN();
+  } else if (n_evaluated < n_docs) {
+    // Ratio estimate of the total over all documents with the document
+    // lengths as auxiliary variable.
+    double ratio = result.n_tokens_evaluated > 0 ?
+      log_likelihood / result.n_tokens_evaluated : 0.0;
+    log_likelihood += ratio * (result.n_tokens - result.n_tokens_evaluated);
+
+    if (n_evaluated > 1) {
+      double residuals = 0;
+      for (std::size_t i = 0; i < n_evaluated; ++i) {
+        double residual = doc_log_likelihoods[i] - ratio * doc_lengths[i];
+        residuals += residual * residual;
+      }
 
-        if (type < 0 || type >= type_topic_counts_.size()) continue;
+      sampling_variance = static_cast<double>(n_docs) * n_docs *
+        (1.0 - static_cast<double>(n_evaluated) / n_docs) * residuals / (n_evaluated - 1) / n_evaluated;
+    } else {
+      sampling_variance = std::numeric_limits<double>::quiet_NaN();
+    }
+  }
 
-        state.type = type;
-        state.type_topic_counts = type_topic_counts_.at(type);
+  result.log_likelihood = log_likelihood;
+  result.standard_error = std::sqrt(sampling_variance + particle_variance);
+  result.complete = result.min_particles == n_particles;
+  result.seconds = std::chrono::duration<double>(Clock::now() - started).count();
 
-        old_topic = state.doc_topics.at(position);
+  return result;
+}
 
-        remove_topic_and_update_state_and_coefficients(state, old_topic);
+double LeftToRightEvaluator::evaluate(const DocumentTypeSequence& types,
+                                      std::size_t n_particles,
+                                      bool resampling,
+                                      DocumentState& state,
+                                      std::size_t doc,
+                                      Worker& worker) {
+  std::size_t start = state.length;
+
+  if (types.length() < start)
+    throw std::invalid_argument("document is shorter than its particle state");
 
-        update_topic_scores(state);
+  if (state.particles.empty())
+    state.particles.resize(n_particles);
+  else if (state.particles.size() != n_particles)
+    throw std::invalid_argument("particle state has a different number of particles");
 
-        new_topic = sample_new_topic(state);
+  DoubleMatrix particle_probabilities(n_particles);
+
+  for (std::size_t particle = 0; particle < n_particles; ++particle) {
+    particle_probabilities.at(particle) = get_word_probabilities(types,
+                                                                 resampling,
+                                                                 state.particles.at(particle),
+                                                                 start,
+                                                                 doc,
+                                                                 particle,
+                                                                 worker);
+  }
 
-        if (new_topic == -1)
-          new_topic = old_topic;
+  state.log_likelihood += combine_particles(types, start, particle_probabilities, worker);
+  state.length = types.length();
 
-        add_topic_and_update_state_and_coefficients(state, new_topic, position);
+  return state.log_likelihood;
+}
+
+double LeftToRightEvaluator::combine_particles(const DocumentTypeSequence& types,
+                                               std::size_t start,
+                                               const DoubleMatrix& particle_probabilities,
+                                               Worker& worker) {
+  std::size_t n_particles = particle_probabilities.size();
+  double log_n_particles = log(n_particles);
+  double log_likelihood = 0;
+  double sum;
+
+  for (std::size_t position = 0; position < types.length() - start; ++position) {
+    sum = 0;
+
+    for (std::size_t particle = 0; particle < n_particles; ++particle) {
+      sum += particle_probabilities.at(particle).at(position);
+    }
+
+    if (sum > 0) {
+      double log_probability = log(sum) - log_n_particles;
+      log_likelihood += log_probability;
+
+      if (diagnostics_) {
+        TypeDiagnostic& diagnostic = worker.diagnostics[model_type(types.at(start + position))];
+        diagnostic.log_probability += log_probability;
+        ++diagnostic.n_tokens;
       }
     }
+  }
+
+  return log_likelihood;
+}
+
+void LeftToRightEvaluator::add_particle(const DocumentTypeSequence& types,
+                                        bool resampling,
+                                        AnytimeDocument& document,
+                                        std::size_t doc,
+                                        Worker& worker) {
+  ParticleState particle;
+  DoubleVector probabilities = get_word_probabilities(types, resampling, particle, 0,
+                                                      doc, document.n_particles, worker);
+
+  if (document.probability_sums.empty())
+    document.probability_sums.assign(probabilities.size(), 0.0);
 
-    type = types.at(limit);
+  double log_likelihood = 0;
 
-    if (type < 0 || type >= type_topic_counts_.size()) continue;
+  for (std::size_t position = 0; position < probabilities.size(); ++position) {
+    document.probability_sums[position] += probabilities[position];
+    if (probabilities[position] > 0) log_likelihood += log(probabilities[position]);
+  }
+
+  ++document.n_particles;
+  document.log_likelihood_sum += log_likelihood;
+  document.log_likelihood_squares += log_likelihood * log_likelihood;
+}
+
+DoubleVector LeftToRightEvaluator::get_word_probabilities(const DocumentTypeSequence& types,
+                                                          bool resampling,
+                                                          ParticleState& particle,
+                                                          std::size_t start,
+                                                          std::size_t doc,
+                                                          std::size_t index,
+                                                          Worker& worker) {
+  Lane lane{types};
+
+  lane.doc = doc;
+  lane.index = index;
+  start_lane(lane, particle, index, start, resampling, worker);
+  while (!is_finished(lane)) step(lane, resampling);
+  finish_lane(lane, particle);
+
+  return std::move(lane.word_probabilities);
+}
+
+void LeftToRightEvaluator::start_lane(Lane& lane,
+                                      ParticleState& particle,
+                                      std::size_t index,
+                                      std::size_t start,
+                                      bool resampling,
+                                      Worker& worker) {
+  std::size_t doc_length = lane.types.length();
+
+  lane.start = start;
+  lane.limit = start;
+  lane.position = resampling ? 0 : start;
+  lane.word_probabilities.assign(doc_length - start, 0.0);
+
+  restore_state(lane.state, particle, doc_length, worker);
+  lane.state.stream = particle_stream(seed_, lane.doc, index);
+}
 
+bool LeftToRightEvaluator::is_finished(const Lane& lane) const {
+  return lane.limit >= lane.types.length();
+}
+
+// Positions before the limit are resampled, if resampling, after which the
+// token at the limit is evaluated and the limit moves on.
+void LeftToRightEvaluator::step(Lane& lane, bool resampling) {
+  LocalState& state = lane.state;
+  std::size_t position = lane.position;
+  std::size_t type = model_type(lane.types.at(position));
+  int old_topic, new_topic;
+
+  if (type < n_types_) {
     state.type = type;
-    state.type_topic_counts = type_topic_counts_.at(type);
+    state.type_topic_counts = type_topic_counts_at(*state.worker, type);
+
+    if (position < lane.limit) {
+      old_topic = state.doc_topics.at(position);
+
+      remove_topic_and_update_state_and_coefficients(state, old_topic);
+
+      update_topic_scores(state);
+
+      new_topic = sample_new_topic(state, draw_uniform(state.stream, lane.limit, position));
+
+      if (new_topic == -1)
+        new_topic = old_topic;
+
+      add_topic_and_update_state_and_coefficients(state, new_topic, position);
+    } else {
+      update_topic_scores(state);
 
-    update_topic_scores(state);
+      lane.word_probabilities.at(position - lane.start) += (smoothing_only_mass_ +
+                                                            state.topic_beta_mass +
+                                                            state.topic_term_mass) / (alpha_sum_ + state.tokens_so_far);
 
-    word_probabilities.at(limit) += (smoothing_only_mass_ +
-                                     state.topic_beta_mass +
-                                     state.topic_term_mass) / (alpha_sum_ + tokens_so_far);
+      new_topic = sample_new_topic(state, draw_uniform(state.stream, lane.limit, position));
 
-    new_topic = sample_new_topic(state);
+      if (new_topic == -1)
+        new_topic = n_topics_ - 1;
 
-    if (new_topic == -1)
-      new_topic = n_topics_ - 1;
+      add_topic_and_update_state_and_coefficients(state, new_topic, position);
 
-    add_topic_and_update_state_and_coefficients(state, new_topic, limit);
+      ++state.tokens_so_far;
+    }
+  }
 
-    ++tokens_so_far;
+  if (position < lane.limit) {
+    ++lane.position;
+  } else {
+    ++lane.limit;
+    lane.position = resampling ? 0 : lane.limit;
   }
+}
+
+void LeftToRightEvaluator::finish_lane(Lane& lane, ParticleState& particle) {
+  LocalState& state = lane.state;
+  Worker& worker = *state.worker;
+
+  for (std::size_t i = 0; i < state.non_zero_topics; ++i) {
+    uint topic = state.topic_index.at(i);
+    worker.cached_coefficients.at(topic) = cached_coefficients_.at(topic);
+  }
+
+  particle = std::move(static_cast<ParticleState&>(state));
+}
+
+void LeftToRightEvaluator::restore_state(LocalState& state,
+                                         ParticleState& particle,
+                                         std::size_t doc_length,
+                                         Worker& worker) {
+  static_cast<ParticleState&>(state) = std::move(particle);
+
+  state.worker = &worker;
 
-  for (unsigned i = 0; i < state.non_zero_topics; ++i) {
-    topic = state.topic_index.at(i);
-    cached_coefficients_.at(topic) = alpha_.at(topic) / (topic_counts_.at(topic) + beta_sum_);
+  if (state.topic_counts.empty()) {
+    state.topic_counts = IntVector(n_topics_);
+    state.topic_index = IntVector(n_topics_);
+  } else if (state.topic_counts.size() != n_topics_) {
+    throw std::invalid_argument("particle state has a different number of topics");
   }
 
-  return word_probabilities;
+  state.doc_topics.resize(doc_length, ParticleState::NO_TOPIC);
+
+  state.dense_index = 0;
+
+  state.topic_beta_mass = 0.0;
+  state.topic_term_mass = 0.0;
+
+  state.topic_term_scores = DoubleVector(n_topics_);
+
+  // The document's own topic counts are folded into the cached coefficients
+  // while it is being evaluated.
+  for (std::size_t i = 0; i < state.non_zero_topics; ++i) {
+    uint topic = state.topic_index.at(i);
+    uint count = state.topic_counts.at(topic);
+    double denom = (worker.topic_counts[topic] + beta_sum_);
+
+    state.topic_beta_mass += beta_ * count / denom;
+    worker.cached_coefficients.at(topic) = (alpha_.at(topic) + count) / denom;
+  }
 }
 
 void LeftToRightEvaluator::add_topic_and_update_state_and_coefficients(LocalState& state,
                                                                        uint topic,
-                                                                       uint position) {
+                                                                       std::size_t position) {
   state.doc_topics.at(position) = topic;
   add_or_remove_topic_and_update_state_and_coefficients(state, topic, true);
 }
@@ -161,7 +738,7 @@ void LeftToRightEvaluator::remove_topic_and_update_state_and_coefficients(LocalS
 void LeftToRightEvaluator::add_or_remove_topic_and_update_state_and_coefficients(LocalState& state,
                                                                                  uint topic,
                                                                                  bool incr) {
-  double denom = (topic_counts_.at(topic) + beta_sum_);
+  double denom = (state.worker->topic_counts[topic] + beta_sum_);
 
   state.topic_beta_mass -= beta_ * state.topic_counts.at(topic) / denom;
 
@@ -170,7 +747,7 @@ void LeftToRightEvaluator::add_or_remove_topic_and_update_state_and_coefficients
 
   state.topic_beta_mass += beta_ * state.topic_counts.at(topic) / denom;
 
-  cached_coefficients_.at(topic) = (alpha_.at(topic) + state.topic_counts.at(topic)) / denom;
+  state.worker->cached_coefficients.at(topic) = (alpha_.at(topic) + state.topic_counts.at(topic)) / denom;
 
   if (incr) maintain_dense_index_addition(state, topic);
   else maintain_dense_index_elimination(state, topic);
@@ -217,12 +794,12 @@ void LeftToRightEvaluator::update_topic_scores(LocalState& state) const {
 
   state.topic_term_mass = 0.0;
 
-  while (index < state.type_topic_counts.size() &&
-         state.type_topic_counts.at(index) > 0) {
+  while (index < n_topics_ &&
+         state.type_topic_counts[index] > 0) {
     current_topic = index;
-    current_value = state.type_topic_counts.at(index);
+    current_value = state.type_topic_counts[index];
 
-    score = cached_coefficients_.at(current_topic) * current_value;
+    score = state.worker->cached_coefficients.at(current_topic) * current_value;
 
     state.topic_term_mass += score;
     state.topic_term_scores.at(index) = score;
@@ -231,10 +808,11 @@ void LeftToRightEvaluator::update_topic_scores(LocalState& state) const {
   }
 }
 
-int LeftToRightEvaluator::sample_new_topic(LocalState& state) {
-  double sample = sampler_.next() * (smoothing_only_mass_ +
-                                     state.topic_beta_mass +
-                                     state.topic_term_mass);
+int LeftToRightEvaluator::sample_new_topic(LocalState& state, double uniform) const {
+  const Count* topic_counts = state.worker->topic_counts;
+  double sample = uniform * (smoothing_only_mass_ +
+                             state.topic_beta_mass +
+                             state.topic_term_mass);
   double orig_sample = sample;
 
   int topic, new_topic = -1;
@@ -257,7 +835,7 @@ int LeftToRightEvaluator::sample_new_topic(LocalState& state) {
       for (state.dense_index = 0; state.dense_index < state.non_zero_topics; ++state.dense_index) {
         topic = state.topic_index.at(state.dense_index);
 
-        sample -= state.topic_counts.at(topic) / (topic_counts_.at(topic) + beta_sum_);
+        sample -= state.topic_counts.at(topic) / (topic_counts[topic] + beta_sum_);
 
         if (sample <= 0.0) {
           new_topic = topic;
@@ -268,11 +846,11 @@ int LeftToRightEvaluator::sample_new_topic(LocalState& state) {
       sample -= state.topic_beta_mass;
       sample /= beta_;
       new_topic = 0;
-      sample -= alpha_.at(new_topic) / (topic_counts_.at(new_topic) + beta_sum_);
+      sample -= alpha_.at(new_topic) / (topic_counts[new_topic] + beta_sum_);
 
       while (sample > 0.0) {
         ++new_topic;
-        sample -= alpha_.at(new_topic) / (topic_counts_.at(new_topic) + beta_sum_);
+        sample -= alpha_.at(new_topic) / (topic_counts[new_topic] + beta_sum_);
       }
     }
   }
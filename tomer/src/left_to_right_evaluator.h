@@ -1,64 +1,194 @@
 #ifndef LEFT_TO_RIGHT_EVALUATOR_H
 #define LEFT_TO_RIGHT_EVALUATOR_H
 
+#include <cstdint>
 #include <vector>
-#include <random>
+#include <map>
+#include <memory>
+#include <unordered_map>
 
 #include "def.h"
+#include "numa.h"
+#include "particle_state.h"
+#include "shared_model.h"
+#include "type_mapping.h"
 #include "type_sequence.h"
 #include "type_sequence_container.h"
+#include "type_sequence_view.h"
 
 using DocumentTypeSequence = TypeSequence;
-using CorpusTypeSequence = TypeSequenceContainer;
+using CorpusTypeSequence = TypeSequenceView;
+
+// The summed log predictive probability of all evaluated tokens of a type and
+// their number.
+struct TypeDiagnostic {
+  double log_probability;
+  Count n_tokens;
+};
+
+using TypeDiagnostics = std::map<std::size_t, TypeDiagnostic>;
 
 class LeftToRightEvaluator {
 private:
-  struct UniformSampler {
-    std::random_device dev_;
-    std::mt19937 gen_;
-    std::uniform_real_distribution<double> dist_;
+  // Everything a thread mutates while evaluating documents, plus the model
+  // replica it reads from.
+  struct Worker {
+    DoubleVector cached_coefficients;
 
-    UniformSampler()
-      : dev_{}, gen_{dev_()}, dist_{0.0, 1.0}
-    {}
+    const Count* topic_counts;
+    const uint* type_topic_counts;
 
-    double next() { return dist_(gen_); }
+    std::unordered_map<std::size_t, TypeDiagnostic> diagnostics;
   };
 
-  struct LocalState {
+  // The particles a document has been evaluated with so far in anytime
+  // evaluation: the summed word probabilities of all particles and the sums
+  // of the log-likelihoods of the particles and their squares.
+  struct AnytimeDocument {
+    DoubleVector probability_sums;
+    std::size_t n_particles;
+    double log_likelihood_sum;
+    double log_likelihood_squares;
+
+    AnytimeDocument()
+      : probability_sums{}, n_particles{0}, log_likelihood_sum{0.0}, log_likelihood_squares{0.0}
+    {}
+  };
+
+  struct LocalState : ParticleState {
+    Worker* worker;
+
+    // The random stream of the particle, see draw_uniform.
+    std::uint64_t stream;
+
     std::size_t dense_index;
-    std::size_t non_zero_topics;
 
     double topic_beta_mass;
     double topic_term_mass;
 
-    IntVector doc_topics;
-    IntVector topic_counts;
-    IntVector topic_index;
-
     std::size_t type;
-    IntVector type_topic_counts;
+    const uint* type_topic_counts;
 
     DoubleVector topic_term_scores;
     IntVector topic_term_indices;
     IntVector topic_term_values;
   };
 
+  // One particle of one document in the middle of its evaluation. Lanes are
+  // advanced a token at a time, so that a thread can interleave several of
+  // them and fetch the model row of the next token of one while it samples
+  // the others.
+  struct Lane {
+    LocalState state;
+    DocumentTypeSequence types;
+    std::size_t doc;
+    std::size_t index;
+    std::size_t start;
+    std::size_t limit;
+    std::size_t position;
+    DoubleVector word_probabilities;
+
+    Lane(const DocumentTypeSequence& types)
+      : state{}, types{types}, doc{0}, index{0}, start{0}, limit{0}, position{0}, word_probabilities{}
+    {}
+  };
+
 public:
+  struct AnytimeResult {
+    double log_likelihood;
+    double standard_error;
+    std::size_t n_docs;
+    std::size_t n_docs_evaluated;
+    Count n_tokens;
+    Count n_tokens_evaluated;
+    std::size_t min_particles;
+    std::size_t n_evaluations;
+    bool complete;
+    double seconds;
+  };
+
   LeftToRightEvaluator(std::size_t n_topics,
                        const DoubleVector& alpha,
                        double beta,
-                       const IntVector& topic_counts,
+                       const CountVector& topic_counts,
                        const IntMatrix& type_topic_counts);
+  LeftToRightEvaluator(SharedModel::SPtr model);
 
   ~LeftToRightEvaluator() = default;
 
+  // Documents are evaluated by n_threads threads (0 uses all cores). On
+  // machines with several NUMA nodes the threads are bound to the nodes
+  // round-robin and read the model according to the placement. A shared
+  // model is never interleaved, since other processes map its pages too.
+  void set_parallelism(std::size_t n_threads, NumaPlacement placement);
+
+  // Every thread evaluates the particles of n_lanes documents at a time,
+  // switching between them after every token, so that the cache misses on
+  // the model rows of large vocabularies overlap instead of stalling the
+  // thread one after the other. Each lane has its own copy of the
+  // coefficients, and the particles of a document are combined in the
+  // same order, so results do not depend on the number of lanes. One lane
+  // evaluates documents one at a time.
+  void set_interleaving(std::size_t n_lanes);
+
+  // Every particle of every document draws its uniforms from its own stream,
+  // which depends on the seed, the position of the document in the corpus
+  // and the particle only. Results are therefore the same for any number of
+  // threads and lanes, and a resumed document continues as if it had been
+  // evaluated at once. The seed is random unless set.
+  void set_seed(std::uint64_t seed);
+
+  // Translates the types of the evaluated corpora to the types of the model
+  // while tokens are sampled, so a corpus encoded once can be evaluated on
+  // models with other alphabets. Unmapped types are out of vocabulary and
+  // skipped. Diagnostics are kept by model type.
+  void set_type_mapping(const TypeMapping& mapping);
+
+  // While diagnostics are enabled every evaluated token adds its log
+  // predictive probability to the diagnostic of its type. Enabling them
+  // discards what was collected before.
+  void set_diagnostics(bool enabled);
+  TypeDiagnostics diagnostics() const;
+
   double evaluate(const CorpusTypeSequence& types,
                   std::size_t n_particles,
                   bool resampling);
 
+  // The log-likelihood of every document of the corpus.
+  DoubleVector evaluate_documents(const CorpusTypeSequence& types,
+                                  std::size_t n_particles,
+                                  bool resampling);
+
+  // Evaluates the tokens of the document beyond state.length and updates the
+  // state, so a growing document can be evaluated incrementally. Returns the
+  // log-likelihood of the whole document. doc is the position of the
+  // document in its corpus, which selects its random streams.
+  double evaluate(const DocumentTypeSequence& types,
+                  std::size_t n_particles,
+                  bool resampling,
+                  DocumentState& state,
+                  std::size_t doc);
+
+  // Evaluates the corpus until all documents have n_particles particles or
+  // the time budget runs out, whichever is first. Particles are added in
+  // passes, one particle for every document per pass and the documents in
+  // random order. After an early stop every document therefore has k or
+  // k + 1 particles, and those with k + 1 are a random sample. A
+  // document-particle evaluation that has started when time runs out is
+  // completed.
+  //
+  // The log-likelihood of documents not reached is extrapolated from the mean
+  // per-token log-likelihood of those that were. The standard error combines
+  // the sampling error of this ratio estimate with the variance between the
+  // particles of every document evaluated with more than one particle.
+  AnytimeResult evaluate_anytime(const CorpusTypeSequence& types,
+                                 std::size_t n_particles,
+                                 bool resampling,
+                                 double seconds);
+
 private:
   std::size_t n_topics_;
+  std::size_t n_types_;
   double beta_;
   double beta_sum_;
   DoubleVector alpha_;
@@ -66,18 +196,103 @@ private:
 
   double smoothing_only_mass_;
 
-  IntVector topic_counts_;
-  IntMatrix type_topic_counts_;
+  // The model counts are either owned by the evaluator or mapped from a
+  // shared model, the pointers below refer to whichever holds them.
+  CountVector topic_counts_storage_;
+  IntVector type_topic_counts_storage_;
+  SharedModel::SPtr shared_model_;
+
+  const Count* topic_counts_;
+  const uint* type_topic_counts_;
   DoubleVector cached_coefficients_;
 
-  UniformSampler sampler_;
+  std::size_t n_threads_;
+  std::size_t n_lanes_;
+  NumaPlacement placement_;
+  std::uint64_t seed_;
+
+  // Per-node copies of the counts for NumaPlacement::REPLICATE.
+  std::vector<CountVector> topic_counts_replicas_;
+  std::vector<IntVector> type_topic_counts_replicas_;
+  bool interleaved_;
+
+  // n_lanes_ workers per thread, those of a thread next to each other.
+  std::vector<std::unique_ptr<Worker>> workers_;
+
+  bool diagnostics_;
+
+  // Corpus to model types, none if the corpus uses the model's types.
+  std::unique_ptr<const TypeMapping> type_mapping_;
+
+  void initialize_coefficients();
+
+  void prepare_workers(std::size_t n_workers);
+  void place_model();
+
+  const uint* type_topic_counts_at(const Worker& worker, std::size_t type) const;
+
+  Worker& thread_worker(std::size_t thread);
+
+  // Calls f(i, thread) for every i in [begin, end) on n_threads_ threads like
+  // parallel_for. If the model is placed by NUMA node, every thread is bound
+  // to its node before its first index. The pool restores the affinity of
+  // its workers after every task, so binding is redone for every call.
+  template <typename Function>
+  void parallel_for_on_nodes(std::size_t begin, std::size_t end, Function f);
+
+  std::size_t model_type(std::size_t type) const;
+
+  DoubleVector evaluate_interleaved(const CorpusTypeSequence& types,
+                                    std::size_t n_particles,
+                                    bool resampling);
+
+  double evaluate(const DocumentTypeSequence& types,
+                  std::size_t n_particles,
+                  bool resampling,
+                  DocumentState& state,
+                  std::size_t doc,
+                  Worker& worker);
+
+  // The log-likelihood of the tokens of a document from start on, from the
+  // word probabilities of each of its particles.
+  double combine_particles(const DocumentTypeSequence& types,
+                           std::size_t start,
+                           const DoubleMatrix& particle_probabilities,
+                           Worker& worker);
+
+  void add_particle(const DocumentTypeSequence& types,
+                    bool resampling,
+                    AnytimeDocument& document,
+                    std::size_t doc,
+                    Worker& worker);
 
   DoubleVector get_word_probabilities(const DocumentTypeSequence& types,
-                                      bool resampling);
+                                      bool resampling,
+                                      ParticleState& particle,
+                                      std::size_t start,
+                                      std::size_t doc,
+                                      std::size_t index,
+                                      Worker& worker);
+
+  // Starts the particle with the given index of the document lane.doc.
+  void start_lane(Lane& lane,
+                  ParticleState& particle,
+                  std::size_t index,
+                  std::size_t start,
+                  bool resampling,
+                  Worker& worker);
+  bool is_finished(const Lane& lane) const;
+  void step(Lane& lane, bool resampling);
+  void finish_lane(Lane& lane, ParticleState& particle);
+
+  void restore_state(LocalState& state,
+                     ParticleState& particle,
+                     std::size_t doc_length,
+                     Worker& worker);
 
   void add_topic_and_update_state_and_coefficients(LocalState& state,
                                                    uint topic,
-                                                   uint position);
+                                                   std::size_t position);
   void remove_topic_and_update_state_and_coefficients(LocalState& state,
                                                       uint topic);
   void add_or_remove_topic_and_update_state_and_coefficients(LocalState& state,
@@ -88,7 +303,7 @@ private:
 
   void update_topic_scores(LocalState& state) const;
 
-  int sample_new_topic(LocalState& state);
+  int sample_new_topic(LocalState& state, double uniform) const;
 
 };
 
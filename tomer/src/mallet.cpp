@@ -0,0 +1,262 @@
+#include "mallet.h"
+
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+
+#include "parallel.h"
+
+namespace {
+
+// Fewest bytes worth a chunk of their own in the parallel parser.
+const std::size_t MIN_BYTES_PER_CHUNK = 1 << 20;
+
+std::string read_file(const std::string& path) {
+  std::ifstream in{path, std::ios::binary};
+  if (!in)
+    throw std::runtime_error("could not open '" + path + "'");
+
+  in.seekg(0, std::ios::end);
+  std::string contents(static_cast<std::size_t>(in.tellg()), '\0');
+  in.seekg(0, std::ios::beg);
+  in.read(&contents[0], contents.size());
+
+  if (!in)
+    throw std::runtime_error("could not read '" + path + "'");
+
+  return contents;
+}
+
+bool is_space(char c) {
+  return c == ' ' || c == '\t' || c == '\r';
+}
+
+void skip_spaces(const char*& p, const char* end) {
+  while (p < end && is_space(*p)) ++p;
+}
+
+bool parse_unsigned(const char*& p, const char* end, std::uint64_t& value) {
+  const char* start = p;
+  value = 0;
+
+  while (p < end && *p >= '0' && *p <= '9') {
+    value = value * 10 + (*p - '0');
+    ++p;
+  }
+
+  return p != start;
+}
+
+// The lines of one chunk of the file, with the topics and counts of all
+// lines back to back.
+struct Chunk {
+  std::vector<std::size_t> types;
+  std::vector<std::string> tokens;
+  std::vector<std::size_t> lengths;
+  IntVector topics;
+  IntVector counts;
+  std::size_t n_topics = 0;
+};
+
+void parse_chunk(const char* begin, const char* end, Chunk& chunk) {
+  const char* line = begin;
+
+  while (line < end) {
+    const char* line_end = std::find(line, end, '\n');
+    const char* p = line;
+
+    skip_spaces(p, line_end);
+
+    if (p < line_end) {
+      std::uint64_t type;
+      if (!parse_unsigned(p, line_end, type) || p == line_end || !is_space(*p))
+        throw std::runtime_error("malformed word-topic counts line '" +
+                                 std::string(line, line_end) + "'");
+
+      skip_spaces(p, line_end);
+      const char* token = p;
+      while (p < line_end && !is_space(*p)) ++p;
+
+      chunk.types.push_back(type);
+      chunk.tokens.push_back(std::string(token, p));
+
+      std::size_t length = 0;
+      for (skip_spaces(p, line_end); p < line_end; skip_spaces(p, line_end)) {
+        std::uint64_t topic;
+        std::uint64_t count;
+
+        if (!parse_unsigned(p, line_end, topic) || p == line_end || *p++ != ':' ||
+            !parse_unsigned(p, line_end, count) || (p < line_end && !is_space(*p)))
+          throw std::runtime_error("malformed word-topic counts line '" +
+                                   std::string(line, line_end) + "'");
+
+        if (topic >= std::numeric_limits<uint>::max() || count > std::numeric_limits<uint>::max())
+          throw std::overflow_error("topic or count does not fit in 32 bits");
+
+        chunk.topics.push_back(topic);
+        chunk.counts.push_back(count);
+        chunk.n_topics = std::max<std::size_t>(chunk.n_topics, topic + 1);
+        ++length;
+      }
+
+      chunk.lengths.push_back(length);
+    }
+
+    line = line_end + 1;
+  }
+}
+
+}
+
+WordTopicCounts::WordTopicCounts()
+  : alphabet{}, n_topics{0}, topic_counts{}, row_offsets{0}, topics{}, counts{}
+{
+
+}
+
+std::size_t WordTopicCounts::n_types() const {
+  return row_offsets.size() - 1;
+}
+
+WordTopicCounts WordTopicCounts::read_mallet(const std::string& path,
+                                             std::size_t n_topics,
+                                             std::size_t n_threads) {
+  std::string contents = read_file(path);
+  const char* data = contents.data();
+  std::size_t size = contents.size();
+
+  if (n_threads == 0) n_threads = default_n_threads();
+  std::size_t n_chunks = std::max<std::size_t>(1, std::min(n_threads, size / MIN_BYTES_PER_CHUNK));
+
+  // Chunks start right after a newline so that no line is split.
+  std::vector<std::size_t> bounds(n_chunks + 1, size);
+  bounds[0] = 0;
+  for (std::size_t chunk = 1; chunk < n_chunks; ++chunk) {
+    std::size_t start = std::max(bounds[chunk - 1], chunk * (size / n_chunks));
+    const char* newline = std::find(data + start, data + size, '\n');
+    bounds[chunk] = std::min<std::size_t>(newline - data + 1, size);
+  }
+
+  std::vector<Chunk> chunks(n_chunks);
+  parallel_for(0, n_chunks, n_chunks, [&](std::size_t chunk, std::size_t) {
+    parse_chunk(data + bounds[chunk], data + bounds[chunk + 1], chunks[chunk]);
+  });
+
+  WordTopicCounts model;
+
+  std::size_t n_types = 0;
+  std::size_t max_topics = 0;
+  for (auto const& chunk : chunks) {
+    n_types += chunk.types.size();
+    max_topics = std::max(max_topics, chunk.n_topics);
+  }
+
+  if (n_topics == 0)
+    n_topics = max_topics;
+  else if (max_topics > n_topics)
+    throw std::invalid_argument("word-topic counts have more than " + std::to_string(n_topics) +
+                                " topics");
+
+  model.n_topics = n_topics;
+
+  // Types must number the lines 0, ..., n_types - 1 in any order.
+  std::vector<std::size_t> row_lengths(n_types, 0);
+  std::vector<bool> seen(n_types, false);
+  std::map<Alphabet::Token, Alphabet::Type> tokens;
+
+  for (auto& chunk : chunks) {
+    for (std::size_t line = 0; line < chunk.types.size(); ++line) {
+      std::size_t type = chunk.types[line];
+
+      if (type >= n_types || seen[type])
+        throw std::invalid_argument("word-topic counts must have exactly one line for each type");
+      seen[type] = true;
+      row_lengths[type] = chunk.lengths[line];
+
+      if (!tokens.insert(std::make_pair(std::move(chunk.tokens[line]), type)).second)
+        throw std::invalid_argument("token of type " + std::to_string(type) +
+                                    " occurs more than once");
+    }
+  }
+
+  model.alphabet = Alphabet{tokens};
+
+  model.row_offsets.resize(n_types + 1);
+  for (std::size_t type = 0; type < n_types; ++type) {
+    model.row_offsets[type + 1] = model.row_offsets[type] + row_lengths[type];
+  }
+
+  model.topics.resize(model.row_offsets.back());
+  model.counts.resize(model.row_offsets.back());
+
+  std::vector<CountVector> topic_counts(n_chunks);
+
+  parallel_for(0, n_chunks, n_chunks, [&](std::size_t c, std::size_t) {
+    const Chunk& chunk = chunks[c];
+    CountVector& local = topic_counts[c];
+    local.assign(n_topics, 0);
+
+    std::size_t entry = 0;
+    for (std::size_t line = 0; line < chunk.types.size(); ++line) {
+      std::size_t offset = model.row_offsets[chunk.types[line]];
+
+      for (std::size_t i = 0; i < chunk.lengths[line]; ++i, ++entry) {
+        model.topics[offset + i] = chunk.topics[entry];
+        model.counts[offset + i] = chunk.counts[entry];
+        local[chunk.topics[entry]] += chunk.counts[entry];
+      }
+    }
+  });
+
+  model.topic_counts.assign(n_topics, 0);
+  for (auto const& local : topic_counts) {
+    for (std::size_t topic = 0; topic < n_topics; ++topic) {
+      model.topic_counts[topic] += local[topic];
+    }
+  }
+
+  return model;
+}
+
+TopicKeys TopicKeys::read_mallet(const std::string& path) {
+  std::ifstream in{path};
+  if (!in)
+    throw std::runtime_error("could not open '" + path + "'");
+
+  std::map<std::size_t, std::pair<double, std::vector<std::string>>> topics;
+  std::string line;
+
+  while (std::getline(in, line)) {
+    if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+
+    std::stringstream ss{line};
+    std::size_t topic;
+    double alpha;
+
+    if (!(ss >> topic >> alpha))
+      throw std::runtime_error("malformed topic keys line '" + line + "'");
+
+    std::vector<std::string> keys;
+    std::string key;
+    while (ss >> key) keys.push_back(key);
+
+    if (!topics.insert(std::make_pair(topic, std::make_pair(alpha, keys))).second)
+      throw std::invalid_argument("topic " + std::to_string(topic) + " occurs more than once");
+  }
+
+  TopicKeys topic_keys;
+
+  std::size_t expected = 0;
+  for (auto& entry : topics) {
+    if (entry.first != expected++)
+      throw std::invalid_argument("topic keys must have one line for each topic");
+
+    topic_keys.alpha.push_back(entry.second.first);
+    topic_keys.keys.push_back(std::move(entry.second.second));
+  }
+
+  return topic_keys;
+}
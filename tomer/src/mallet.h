@@ -0,0 +1,47 @@
+#ifndef MALLET_H
+#define MALLET_H
+
+#include <string>
+#include <vector>
+
+#include "def.h"
+#include "alphabet.h"
+
+// The aggregated model MALLET writes with --word-topic-counts-file, one line
+// per type:
+//
+//   <type> <token> <topic>:<count> <topic>:<count> ...
+//
+// Type-topic counts are kept sparse in compressed rows: the topics and counts
+// of type t are at [row_offsets[t], row_offsets[t + 1]).
+struct WordTopicCounts {
+  Alphabet alphabet;
+  std::size_t n_topics;
+  CountVector topic_counts;
+  std::vector<std::size_t> row_offsets;
+  IntVector topics;
+  IntVector counts;
+
+  WordTopicCounts();
+
+  std::size_t n_types() const;
+
+  // Lines are parsed in parallel. If n_topics is 0 it is taken from the
+  // largest topic in the file.
+  static WordTopicCounts read_mallet(const std::string& path,
+                                     std::size_t n_topics,
+                                     std::size_t n_threads);
+};
+
+// The topic summary MALLET writes with --output-topic-keys, one line per
+// topic:
+//
+//   <topic>\t<alpha>\t<token> <token> ...
+struct TopicKeys {
+  DoubleVector alpha;
+  std::vector<std::vector<std::string>> keys;
+
+  static TopicKeys read_mallet(const std::string& path);
+};
+
+#endif // MALLET_H
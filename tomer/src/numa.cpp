@@ -0,0 +1,162 @@
+#include "numa.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#ifdef __linux__
+#include <dirent.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
+
+namespace {
+
+// Parses a kernel cpulist such as "0-3,8-11".
+std::vector<int> parse_cpulist(const std::string& list) {
+  std::vector<int> cpus;
+  std::stringstream ss{list};
+  std::string range;
+
+  while (std::getline(ss, range, ',')) {
+    if (range.empty() || range == "\n") continue;
+
+    std::size_t dash = range.find('-');
+    int first = std::atoi(range.substr(0, dash).c_str());
+    int last = dash == std::string::npos ? first : std::atoi(range.substr(dash + 1).c_str());
+
+    for (int cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+  }
+
+  return cpus;
+}
+
+}
+
+NumaTopology::NumaTopology()
+  : nodes_{}, cpus_{}
+{
+#ifdef __linux__
+  const std::string root = "/sys/devices/system/node";
+
+  if (DIR* dir = opendir(root.c_str())) {
+    while (dirent* entry = readdir(dir)) {
+      std::string name = entry->d_name;
+      if (name.compare(0, 4, "node") != 0 || name.size() == 4 ||
+          name.find_first_not_of("0123456789", 4) != std::string::npos) continue;
+
+      std::ifstream in{root + "/" + name + "/cpulist"};
+      std::string list;
+      std::getline(in, list);
+
+      std::vector<int> cpus = parse_cpulist(list);
+      if (cpus.empty()) continue;
+
+      nodes_.push_back(std::atoi(name.c_str() + 4));
+      cpus_.push_back(cpus);
+    }
+    closedir(dir);
+  }
+#endif
+
+  if (nodes_.empty()) {
+    std::size_t n_cpus = std::max(1u, std::thread::hardware_concurrency());
+    CpuSet all(n_cpus);
+    for (std::size_t cpu = 0; cpu < n_cpus; ++cpu) all[cpu] = cpu;
+
+    nodes_.push_back(0);
+    cpus_.push_back(all);
+  }
+}
+
+const NumaTopology& NumaTopology::get() {
+  static const NumaTopology topology{};
+  return topology;
+}
+
+NumaTopology::size_type NumaTopology::n_nodes() const {
+  return nodes_.size();
+}
+
+int NumaTopology::id(NumaTopology::size_type node) const {
+  return nodes_.at(node);
+}
+
+const NumaTopology::CpuSet& NumaTopology::cpus(NumaTopology::size_type node) const {
+  return cpus_.at(node);
+}
+
+AffinityGuard::AffinityGuard()
+  : saved_{false}, previous_{}
+{
+#ifdef __linux__
+  previous_.resize(sizeof(cpu_set_t));
+  saved_ = sched_getaffinity(0, sizeof(cpu_set_t),
+                             reinterpret_cast<cpu_set_t*>(previous_.data())) == 0;
+#endif
+}
+
+AffinityGuard::~AffinityGuard() {
+#ifdef __linux__
+  if (saved_)
+    sched_setaffinity(0, sizeof(cpu_set_t), reinterpret_cast<cpu_set_t*>(previous_.data()));
+#endif
+}
+
+void bind_to_node(NumaTopology::size_type node) {
+#ifdef __linux__
+  const NumaTopology& topology = NumaTopology::get();
+  if (topology.n_nodes() < 2) return;
+
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int cpu : topology.cpus(node % topology.n_nodes())) {
+    if (cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+  }
+  sched_setaffinity(0, sizeof(cpu_set_t), &set);
+#else
+  (void) node;
+#endif
+}
+
+bool interleave_pages(void* address, std::size_t size) {
+#if defined(__linux__) && defined(SYS_mbind)
+  const NumaTopology& topology = NumaTopology::get();
+  if (topology.n_nodes() < 2) return false;
+
+  const int MPOL_INTERLEAVE_ = 3;
+  const unsigned MPOL_MF_MOVE_ = 1 << 1;
+
+  long page = sysconf(_SC_PAGESIZE);
+  std::uintptr_t begin = reinterpret_cast<std::uintptr_t>(address);
+  std::uintptr_t end = begin + size;
+  begin = (begin + page - 1) / page * page;
+  end = end / page * page;
+  if (end <= begin) return false;
+
+  const std::size_t bits = 8 * sizeof(unsigned long);
+
+  int max_node = 0;
+  for (std::size_t node = 0; node < topology.n_nodes(); ++node)
+    max_node = std::max(max_node, topology.id(node));
+
+  std::vector<unsigned long> mask(max_node / bits + 1, 0);
+  for (std::size_t node = 0; node < topology.n_nodes(); ++node) {
+    int id = topology.id(node);
+    mask[id / bits] |= 1UL << (id % bits);
+  }
+
+  return syscall(SYS_mbind, reinterpret_cast<void*>(begin), end - begin, MPOL_INTERLEAVE_,
+                 mask.data(), max_node + 2, MPOL_MF_MOVE_) == 0;
+#else
+  (void) address;
+  (void) size;
+  return false;
+#endif
+}
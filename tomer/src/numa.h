@@ -0,0 +1,60 @@
+#ifndef NUMA_H
+#define NUMA_H
+
+#include <vector>
+
+// How read-only model arrays are placed on machines with several NUMA nodes.
+enum class NumaPlacement {
+  NONE,        // one copy wherever the allocator put it
+  REPLICATE,   // one copy per node, threads read the copy of their node
+  INTERLEAVE   // one copy with its pages spread evenly over all nodes
+};
+
+// The NUMA nodes of the machine and the CPUs that belong to each. Machines
+// without NUMA information, including non-Linux systems, are reported as a
+// single node holding all CPUs so that callers need no special cases.
+class NumaTopology {
+public:
+  using CpuSet = std::vector<int>;
+  using size_type = std::size_t;
+
+  static const NumaTopology& get();
+
+  size_type n_nodes() const;
+  int id(size_type node) const;
+  const CpuSet& cpus(size_type node) const;
+
+private:
+  std::vector<int> nodes_;
+  std::vector<CpuSet> cpus_;
+
+  NumaTopology();
+
+};
+
+// Restores the CPU affinity the calling thread had at construction when it
+// goes out of scope.
+class AffinityGuard {
+public:
+  AffinityGuard();
+  ~AffinityGuard();
+
+private:
+  bool saved_;
+  std::vector<unsigned char> previous_;
+
+  AffinityGuard(const AffinityGuard& other) = delete;
+  AffinityGuard& operator=(const AffinityGuard& rhs) = delete;
+
+};
+
+// Binds the calling thread to the CPUs of a node, taken modulo the number of
+// nodes. Binding is best effort and does nothing on single-node machines or
+// where it is not supported.
+void bind_to_node(NumaTopology::size_type node);
+
+// Spreads the pages of [address, address + size) round-robin over all nodes.
+// Returns false if the memory was left where it is.
+bool interleave_pages(void* address, std::size_t size);
+
+#endif // NUMA_H
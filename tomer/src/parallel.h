@@ -0,0 +1,58 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+
+#include "thread_pool.h"
+
+// Number of worker threads to use when the caller asks for 0.
+inline std::size_t default_n_threads() {
+  return ThreadPool::get().size();
+}
+
+// Calls f(i, thread) for every i in [begin, end). Indices are handed out
+// dynamically in chunks of `grain` so uneven work is balanced, `thread` is
+// the index of the calling worker in [0, n_threads) and can be used to pick
+// thread-local scratch space. Work runs on the shared ThreadPool, so at most
+// its size threads are used. The first exception thrown by f is rethrown
+// in the calling thread once all workers have stopped.
+template <typename Function>
+void parallel_for(std::size_t begin,
+                  std::size_t end,
+                  std::size_t n_threads,
+                  Function f,
+                  std::size_t grain = 1) {
+  if (end <= begin) return;
+  if (n_threads == 0) n_threads = default_n_threads();
+  n_threads = std::min({n_threads, default_n_threads(), (end - begin + grain - 1) / grain});
+
+  std::atomic<std::size_t> next{begin};
+  std::atomic<bool> failed{false};
+  std::exception_ptr error;
+  std::mutex error_mutex;
+
+  auto worker = [&](std::size_t thread) {
+    try {
+      while (!failed) {
+        std::size_t first = next.fetch_add(grain);
+        if (first >= end) break;
+
+        std::size_t last = std::min(first + grain, end);
+        for (std::size_t i = first; i < last; ++i) f(i, thread);
+      }
+    } catch (...) {
+      std::lock_guard<std::mutex> lock{error_mutex};
+      if (!error) error = std::current_exception();
+      failed = true;
+    }
+  };
+
+  ThreadPool::get().run(n_threads, worker);
+
+  if (error) std::rethrow_exception(error);
+}
+
+#endif // PARALLEL_H
@@ -0,0 +1,161 @@
+#include "particle_state.h"
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+const std::uint32_t MAGIC = 0x544d5053; // "TMPS"
+const std::uint32_t VERSION = 2;
+
+// Bytes of a serialized particle with empty vectors: its two counters and
+// the sizes of its three vectors.
+const std::size_t MIN_PARTICLE_SIZE = 5 * sizeof(std::uint64_t);
+
+template <typename T>
+void write(std::string& out, const T& value) {
+  out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void write(std::string& out, const IntVector& values) {
+  write<std::uint64_t>(out, values.size());
+  out.append(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(uint));
+}
+
+class Reader {
+public:
+  Reader(const std::string& data) : data_{data}, offset_{0} {}
+
+  template <typename T>
+  T read() {
+    T value;
+    check(sizeof(T));
+    std::memcpy(&value, data_.data() + offset_, sizeof(T));
+    offset_ += sizeof(T);
+    return value;
+  }
+
+  // Reads a count of elements of element_size bytes each and checks that
+  // they fit in the remaining data before anything is allocated for them.
+  std::size_t read_count(std::size_t element_size) {
+    std::uint64_t count = read<std::uint64_t>();
+    if (count > (data_.size() - offset_) / element_size)
+      throw std::invalid_argument("particle state is truncated");
+    return count;
+  }
+
+  IntVector read_vector() {
+    std::size_t size = read_count(sizeof(uint));
+    IntVector values(size);
+    std::memcpy(values.data(), data_.data() + offset_, size * sizeof(uint));
+    offset_ += size * sizeof(uint);
+    return values;
+  }
+
+private:
+  const std::string& data_;
+  std::size_t offset_;
+
+  void check(std::size_t n) const {
+    if (n > data_.size() - offset_)
+      throw std::invalid_argument("particle state is truncated");
+  }
+};
+
+void check(const ParticleState& particle, std::size_t length) {
+  std::size_t n_topics = particle.topic_counts.size();
+
+  if (particle.doc_topics.size() != length)
+    throw std::invalid_argument("particle state does not assign every token");
+  if (particle.topic_index.size() != n_topics || particle.non_zero_topics > n_topics)
+    throw std::invalid_argument("particle state has an invalid topic index");
+
+  IntVector histogram(n_topics, 0);
+  std::size_t n_assigned = 0;
+
+  for (uint topic : particle.doc_topics) {
+    if (topic == ParticleState::NO_TOPIC) continue;
+    if (topic >= n_topics)
+      throw std::invalid_argument("particle state assigns an unknown topic");
+    ++histogram[topic];
+    ++n_assigned;
+  }
+
+  if (histogram != particle.topic_counts || n_assigned != particle.tokens_so_far)
+    throw std::invalid_argument("particle state topic counts do not match its assignments");
+
+  // The index lists the topics with non-zero counts in increasing order.
+  std::size_t n_non_zero = 0;
+  for (std::size_t topic = 0; topic < n_topics; ++topic) {
+    if (particle.topic_counts[topic] == 0) continue;
+    if (n_non_zero >= particle.non_zero_topics || particle.topic_index[n_non_zero] != topic)
+      throw std::invalid_argument("particle state has an invalid topic index");
+    ++n_non_zero;
+  }
+
+  if (n_non_zero != particle.non_zero_topics)
+    throw std::invalid_argument("particle state has an invalid topic index");
+}
+
+}
+
+const uint ParticleState::NO_TOPIC;
+
+ParticleState::ParticleState()
+  : doc_topics{}, topic_counts{}, topic_index{}, non_zero_topics{0}, tokens_so_far{0}
+{
+
+}
+
+DocumentState::DocumentState()
+  : length{0}, log_likelihood{0.0}, particles{}
+{
+
+}
+
+std::string DocumentState::serialize() const {
+  std::string out;
+
+  write(out, MAGIC);
+  write(out, VERSION);
+  write<std::uint64_t>(out, length);
+  write(out, log_likelihood);
+  write<std::uint64_t>(out, particles.size());
+
+  for (auto const& particle : particles) {
+    write<std::uint64_t>(out, particle.non_zero_topics);
+    write<std::uint64_t>(out, particle.tokens_so_far);
+    write(out, particle.doc_topics);
+    write(out, particle.topic_counts);
+    write(out, particle.topic_index);
+  }
+
+  return out;
+}
+
+DocumentState DocumentState::deserialize(const std::string& data) {
+  Reader reader{data};
+
+  if (reader.read<std::uint32_t>() != MAGIC)
+    throw std::invalid_argument("not a particle state");
+  if (reader.read<std::uint32_t>() != VERSION)
+    throw std::invalid_argument("unsupported particle state version");
+
+  DocumentState state;
+  state.length = reader.read<std::uint64_t>();
+  state.log_likelihood = reader.read<double>();
+  state.particles.resize(reader.read_count(MIN_PARTICLE_SIZE));
+
+  for (auto& particle : state.particles) {
+    particle.non_zero_topics = reader.read<std::uint64_t>();
+    particle.tokens_so_far = reader.read<std::uint64_t>();
+    particle.doc_topics = reader.read_vector();
+    particle.topic_counts = reader.read_vector();
+    particle.topic_index = reader.read_vector();
+
+    check(particle, state.length);
+  }
+
+  return state;
+}
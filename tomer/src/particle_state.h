@@ -0,0 +1,47 @@
+#ifndef PARTICLE_STATE_H
+#define PARTICLE_STATE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "def.h"
+
+// The topic assignments of one left-to-right particle after the first
+// `length` tokens of a document, enough to continue sampling from there.
+// Tokens the model does not know keep NO_TOPIC, so that topic_counts is the
+// histogram of doc_topics.
+struct ParticleState {
+  static const uint NO_TOPIC = UINT32_MAX;
+
+  IntVector doc_topics;
+  IntVector topic_counts;
+  IntVector topic_index;
+  std::size_t non_zero_topics;
+  std::size_t tokens_so_far;
+
+  ParticleState();
+};
+
+// All particles of one document together with the log-likelihood of the
+// tokens evaluated so far. A default constructed state evaluates the document
+// from the beginning.
+struct DocumentState {
+  using Particles = std::vector<ParticleState>;
+
+  std::size_t length;
+  double log_likelihood;
+  Particles particles;
+
+  DocumentState();
+
+  std::string serialize() const;
+
+  // Throws std::invalid_argument unless the data is a complete state whose
+  // particles are consistent: every particle has one assignment per token,
+  // its topic counts are the histogram of its assignments and its topic
+  // index lists exactly the topics with non-zero counts.
+  static DocumentState deserialize(const std::string& data);
+};
+
+#endif // PARTICLE_STATE_H
@@ -0,0 +1,129 @@
+#include "posterior_predictive_check.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+
+#include "alias_table.h"
+#include "parallel.h"
+
+PosteriorPredictiveCheck::PosteriorPredictiveCheck(std::size_t n_topics,
+                                                   std::size_t n_types,
+                                                   double beta)
+  : n_topics_{n_topics}, n_types_{n_types}, beta_{beta}
+{
+
+}
+
+PosteriorPredictiveCheck::Result
+PosteriorPredictiveCheck::mutual_information(const IntVector& docs,
+                                             const IntVector& types,
+                                             const IntVector& topics,
+                                             std::size_t n_replications,
+                                             std::size_t n_threads,
+                                             std::uint64_t seed) const {
+  std::size_t n_tokens = docs.size();
+
+  if (types.size() != n_tokens || topics.size() != n_tokens)
+    throw std::invalid_argument("docs, types and topics must have the same length");
+
+  // Counting sort of the tokens by topic.
+  std::vector<std::size_t> offsets(n_topics_ + 1, 0);
+  for (std::size_t i = 0; i < n_tokens; ++i) {
+    if (topics[i] >= n_topics_ || types[i] >= n_types_)
+      throw std::out_of_range("topic or type out of range");
+    ++offsets[topics[i] + 1];
+  }
+  std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+  DocTypePairs pairs(n_tokens);
+  std::vector<std::size_t> next(offsets.cbegin(), offsets.cend() - 1);
+  for (std::size_t i = 0; i < n_tokens; ++i) {
+    pairs[next[topics[i]]++] = DocTypePair{docs[i], types[i]};
+  }
+
+  if (n_threads == 0) n_threads = default_n_threads();
+  std::vector<CountVector> scratch(n_threads);
+
+  Result result;
+  result.realized = DoubleVector(n_topics_, 0.0);
+  result.replicated = DoubleMatrix(n_topics_, DoubleVector(n_replications, 0.0));
+
+  parallel_for(0, n_topics_, n_threads, [&](std::size_t topic, std::size_t thread) {
+    CountVector& type_counts = scratch[thread];
+    if (type_counts.empty()) type_counts.resize(n_types_, 0);
+
+    DocTypePairs observed(pairs.cbegin() + offsets[topic], pairs.cbegin() + offsets[topic + 1]);
+    if (observed.empty()) return;
+
+    std::sort(observed.begin(), observed.end());
+    result.realized[topic] = mutual_information(observed, type_counts);
+
+    if (n_replications == 0) return;
+
+    DoubleVector weights(n_types_, beta_);
+    for (auto const& pair : observed) weights[pair.second] += 1.0;
+    AliasTable words{weights};
+
+    std::mt19937_64 gen{seed + topic};
+    std::uniform_real_distribution<double> uniform{0.0, 1.0};
+
+    DocTypePairs replicated(observed.size());
+
+    for (std::size_t r = 0; r < n_replications; ++r) {
+      std::size_t begin = 0;
+
+      while (begin < observed.size()) {
+        std::size_t end = begin;
+        while (end < observed.size() && observed[end].first == observed[begin].first) ++end;
+
+        for (std::size_t i = begin; i < end; ++i) {
+          replicated[i] = DocTypePair{observed[begin].first,
+                                      static_cast<uint>(words.sample(uniform(gen)))};
+        }
+        std::sort(replicated.begin() + begin, replicated.begin() + end);
+
+        begin = end;
+      }
+
+      result.replicated[topic][r] = mutual_information(replicated, type_counts);
+    }
+  });
+
+  return result;
+}
+
+double PosteriorPredictiveCheck::mutual_information(const DocTypePairs& pairs,
+                                                    CountVector& type_counts) const {
+  double n = pairs.size();
+  double mi = 0.0;
+
+  for (auto const& pair : pairs) ++type_counts[pair.second];
+
+  std::size_t begin = 0;
+  while (begin < pairs.size()) {
+    std::size_t doc_end = begin;
+    while (doc_end < pairs.size() && pairs[doc_end].first == pairs[begin].first) ++doc_end;
+
+    double doc_count = doc_end - begin;
+
+    std::size_t i = begin;
+    while (i < doc_end) {
+      std::size_t j = i;
+      while (j < doc_end && pairs[j].second == pairs[i].second) ++j;
+
+      double count = j - i;
+      mi += count / n * std::log(count * n / (type_counts[pairs[i].second] * doc_count));
+
+      i = j;
+    }
+
+    begin = doc_end;
+  }
+
+  for (auto const& pair : pairs) type_counts[pair.second] = 0;
+
+  return mi;
+}
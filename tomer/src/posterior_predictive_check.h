@@ -0,0 +1,48 @@
+#ifndef POSTERIOR_PREDICTIVE_CHECK_H
+#define POSTERIOR_PREDICTIVE_CHECK_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "def.h"
+
+// Posterior predictive checks of the per-topic mutual information between
+// words and documents (Mimno and Blei, 2011). The realized discrepancy is
+// computed from the topic assignments of a Gibbs state, replicated
+// discrepancies from datasets where every document keeps its number of
+// tokens per topic but the words are redrawn from the topic's word
+// distribution. Topics are processed in parallel.
+class PosteriorPredictiveCheck {
+public:
+  struct Result {
+    DoubleVector realized;
+    DoubleMatrix replicated;
+  };
+
+  PosteriorPredictiveCheck(std::size_t n_topics, std::size_t n_types, double beta);
+
+  ~PosteriorPredictiveCheck() = default;
+
+  Result mutual_information(const IntVector& docs,
+                            const IntVector& types,
+                            const IntVector& topics,
+                            std::size_t n_replications,
+                            std::size_t n_threads,
+                            std::uint64_t seed) const;
+
+private:
+  using DocTypePair = std::pair<uint, uint>;
+  using DocTypePairs = std::vector<DocTypePair>;
+
+  std::size_t n_topics_;
+  std::size_t n_types_;
+  double beta_;
+
+  // Pairs must be sorted by document and type, type_counts must be zero and
+  // is left zeroed.
+  double mutual_information(const DocTypePairs& pairs, CountVector& type_counts) const;
+
+};
+
+#endif // POSTERIOR_PREDICTIVE_CHECK_H
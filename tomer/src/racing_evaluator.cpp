@@ -0,0 +1,220 @@
+#include "racing_evaluator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+
+namespace {
+
+const int MAX_ITERATIONS = 300;
+const double EPSILON = 1e-15;
+const double TINY = 1e-300;
+
+// Continued fraction of the regularized incomplete beta function, evaluated
+// with the modified Lentz method. Converges quickly for x < (a + 1) / (a + b + 2).
+double beta_fraction(double a, double b, double x) {
+  double c = 1.0;
+  double d = 1.0 - (a + b) * x / (a + 1.0);
+  if (std::fabs(d) < TINY) d = TINY;
+  d = 1.0 / d;
+  double h = d;
+
+  for (int m = 1; m <= MAX_ITERATIONS; ++m) {
+    double aa = m * (b - m) * x / ((a + 2 * m - 1) * (a + 2 * m));
+    d = 1.0 + aa * d;
+    if (std::fabs(d) < TINY) d = TINY;
+    c = 1.0 + aa / c;
+    if (std::fabs(c) < TINY) c = TINY;
+    d = 1.0 / d;
+    h *= d * c;
+
+    aa = -(a + m) * (a + b + m) * x / ((a + 2 * m) * (a + 2 * m + 1));
+    d = 1.0 + aa * d;
+    if (std::fabs(d) < TINY) d = TINY;
+    c = 1.0 + aa / c;
+    if (std::fabs(c) < TINY) c = TINY;
+    d = 1.0 / d;
+    double delta = d * c;
+    h *= delta;
+
+    if (std::fabs(delta - 1.0) < EPSILON) break;
+  }
+
+  return h;
+}
+
+// Regularized incomplete beta function I_x(a, b).
+double incomplete_beta(double a, double b, double x) {
+  if (x <= 0.0) return 0.0;
+  if (x >= 1.0) return 1.0;
+
+  double front = std::exp(std::lgamma(a + b) - std::lgamma(a) - std::lgamma(b) +
+                          a * std::log(x) + b * std::log1p(-x));
+
+  if (x < (a + 1.0) / (a + b + 2.0)) return front * beta_fraction(a, b, x) / a;
+  return 1.0 - front * beta_fraction(b, a, 1.0 - x) / b;
+}
+
+// Probability that Student's t with df degrees of freedom exceeds t >= 0.
+double t_upper_tail(double t, double df) {
+  return 0.5 * incomplete_beta(df / 2.0, 0.5, df / (df + t * t));
+}
+
+// Quantile 1 - p of Student's t with df degrees of freedom, for p < 0.5,
+// found by bisection since the tail is monotone.
+double t_quantile(double p, double df) {
+  double lo = 0.0;
+  double hi = 1.0;
+  while (t_upper_tail(hi, df) > p) {
+    lo = hi;
+    hi *= 2.0;
+  }
+
+  for (int i = 0; i < MAX_ITERATIONS && hi - lo > 1e-12 * hi; ++i) {
+    double mid = lo + (hi - lo) / 2.0;
+    if (t_upper_tail(mid, df) > p) lo = mid;
+    else hi = mid;
+  }
+
+  return hi;
+}
+
+}
+
+void RacingEvaluator::PairedStatistics::add(double difference) {
+  ++n;
+  double delta = difference - mean;
+  mean += delta / n;
+  m2 += delta * (difference - mean);
+}
+
+double RacingEvaluator::PairedStatistics::lower_bound(double t) const {
+  if (n < 2) return -HUGE_VAL;
+  double variance = m2 / (n - 1);
+  return mean - t * std::sqrt(variance / n);
+}
+
+RacingEvaluator::RacingEvaluator(double confidence, std::size_t min_docs)
+  : confidence_{confidence}, min_docs_{std::max<std::size_t>(min_docs, 2)},
+    seed_{std::random_device{}()}, evaluators_{}, corpora_{}
+{
+  if (confidence <= 0.0 || confidence >= 1.0)
+    throw std::invalid_argument("confidence must be in (0, 1)");
+}
+
+void RacingEvaluator::add(LeftToRightEvaluator& evaluator, const CorpusTypeSequence& types) {
+  if (!corpora_.empty() && corpora_.front().size() != types.size())
+    throw std::invalid_argument("all models must be raced on the same documents");
+
+  evaluators_.push_back(&evaluator);
+  corpora_.push_back(types);
+}
+
+void RacingEvaluator::set_seed(std::uint64_t seed) {
+  seed_ = seed;
+}
+
+RacingEvaluator::Result RacingEvaluator::race(std::size_t n_particles, bool resampling) {
+  std::size_t n_models = evaluators_.size();
+
+  if (n_models < 2)
+    throw std::invalid_argument("racing needs at least two models");
+
+  std::size_t n_docs = corpora_.front().size();
+  std::size_t n_pairs = n_models * (n_models - 1) / 2;
+
+  std::vector<std::size_t> order(n_docs);
+  std::iota(order.begin(), order.end(), 0);
+
+  std::mt19937_64 gen{seed_};
+  std::shuffle(order.begin(), order.end(), gen);
+
+  // The models share the seed, so that their particles of a document draw
+  // the same random numbers and their differences vary less.
+  for (auto evaluator : evaluators_) evaluator->set_seed(seed_);
+
+  std::vector<PairedStatistics> statistics(n_pairs);
+  DoubleVector doc_log_likelihood(n_models);
+
+  Result result;
+  result.decided = false;
+  result.winner = 0;
+  result.n_docs = 0;
+  result.log_likelihood = DoubleVector(n_models, 0.0);
+
+  // Each look at the data spends alpha / (n (n + 1)) of the error budget and
+  // every look compares the leader against all other models, so the overall
+  // error stays below 1 - confidence no matter when the race stops, as far as
+  // the paired differences are normal: the variance is estimated, so every
+  // look uses a t quantile with n - 1 degrees of freedom, which is exact for
+  // normal differences and approximate otherwise.
+  double alpha = 1.0 - confidence_;
+
+  for (std::size_t doc : order) {
+    for (std::size_t model = 0; model < n_models; ++model) {
+      DocumentState state;
+      doc_log_likelihood.at(model) = evaluators_.at(model)->evaluate(corpora_.at(model).at(doc),
+                                                                     n_particles,
+                                                                     resampling,
+                                                                     state,
+                                                                     doc);
+      result.log_likelihood.at(model) += doc_log_likelihood.at(model);
+    }
+
+    for (std::size_t i = 0; i < n_models; ++i) {
+      for (std::size_t j = i + 1; j < n_models; ++j) {
+        statistics.at(pair_index(i, j)).add(doc_log_likelihood.at(i) - doc_log_likelihood.at(j));
+      }
+    }
+
+    ++result.n_docs;
+
+    result.winner = std::max_element(result.log_likelihood.cbegin(), result.log_likelihood.cend()) -
+      result.log_likelihood.cbegin();
+
+    if (result.n_docs < min_docs_) continue;
+
+    double n = result.n_docs;
+    double look_alpha = alpha / (n * (n + 1)) / (n_models - 1);
+    double t = t_quantile(look_alpha, n - 1);
+
+    if (is_decided(statistics, result.winner, t)) {
+      result.decided = true;
+      break;
+    }
+  }
+
+  return result;
+}
+
+bool RacingEvaluator::is_decided(const std::vector<PairedStatistics>& statistics,
+                                 std::size_t leader,
+                                 double t) const {
+  for (std::size_t other = 0; other < evaluators_.size(); ++other) {
+    if (other == leader) continue;
+
+    const PairedStatistics& s = statistics.at(pair_index(std::min(leader, other),
+                                                         std::max(leader, other)));
+
+    // The statistics hold differences (lower index - higher index).
+    double bound;
+    if (leader < other) {
+      bound = s.lower_bound(t);
+    } else {
+      PairedStatistics flipped = s;
+      flipped.mean = -s.mean;
+      bound = flipped.lower_bound(t);
+    }
+
+    if (bound <= 0.0) return false;
+  }
+
+  return true;
+}
+
+std::size_t RacingEvaluator::pair_index(std::size_t i, std::size_t j) const {
+  std::size_t n = evaluators_.size();
+  return i * n - i * (i + 1) / 2 + (j - i - 1);
+}
@@ -0,0 +1,66 @@
+#ifndef RACING_EVALUATOR_H
+#define RACING_EVALUATOR_H
+
+#include <cstdint>
+#include <vector>
+
+#include "def.h"
+#include "left_to_right_evaluator.h"
+
+// Compares several models on the same corpus by evaluating the documents in
+// random order, one document on every model at a time. Running statistics of
+// the paired per-document differences are tested after every document and
+// evaluation stops as soon as one model is better than all others at the
+// requested confidence. The test treats the differences as normal with
+// unknown variance, so the confidence is approximate when they are skewed
+// and few documents have been evaluated.
+class RacingEvaluator {
+public:
+  struct Result {
+    bool decided;
+    std::size_t winner;
+    std::size_t n_docs;
+    DoubleVector log_likelihood;
+  };
+
+  RacingEvaluator(double confidence, std::size_t min_docs);
+
+  ~RacingEvaluator() = default;
+
+  // The corpus must be encoded with the alphabet of the evaluator's model, or
+  // the evaluator must translate its types.
+  void add(LeftToRightEvaluator& evaluator, const CorpusTypeSequence& types);
+
+  // Seeds the order of the documents and, when racing, every model.
+  void set_seed(std::uint64_t seed);
+
+  Result race(std::size_t n_particles, bool resampling);
+
+private:
+  struct PairedStatistics {
+    std::size_t n;
+    double mean;
+    double m2;
+
+    PairedStatistics() : n{0}, mean{0.0}, m2{0.0} {}
+
+    void add(double difference);
+    double lower_bound(double t) const;
+  };
+
+  double confidence_;
+  std::size_t min_docs_;
+  std::uint64_t seed_;
+
+  std::vector<LeftToRightEvaluator*> evaluators_;
+  std::vector<CorpusTypeSequence> corpora_;
+
+  bool is_decided(const std::vector<PairedStatistics>& statistics,
+                  std::size_t leader,
+                  double t) const;
+
+  std::size_t pair_index(std::size_t i, std::size_t j) const;
+
+};
+
+#endif // RACING_EVALUATOR_H
@@ -0,0 +1,249 @@
+#include "shared_model.h"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+const char MAGIC[8] = {'T', 'O', 'M', 'E', 'R', 'S', 'M', '1'};
+const std::uint64_t ALIGNMENT = 64;
+
+std::uint64_t align(std::uint64_t offset) {
+  return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+}
+
+// Whether n elements of element_size bytes starting at offset lie within the
+// first size bytes. Divides instead of multiplying so that corrupt counts
+// cannot overflow.
+bool fits(std::uint64_t offset, std::uint64_t n, std::uint64_t element_size, std::uint64_t size) {
+  return offset <= size && n <= (size - offset) / element_size;
+}
+
+}
+
+SharedModel::SharedModel(void* address, SharedModel::size_type size)
+  : address_{address}, size_{size}, header_{static_cast<const Header*>(address)}
+{
+
+}
+
+SharedModel::~SharedModel() {
+  munmap(address_, size_);
+}
+
+void SharedModel::create(const std::string& name,
+                         const Alphabet& alphabet,
+                         const DoubleVector& alpha,
+                         double beta,
+                         const CountVector& topic_counts,
+                         const IntMatrix& type_topic_counts) {
+  std::uint64_t n_topics = topic_counts.size();
+  std::uint64_t n_types = type_topic_counts.size();
+
+  if (alpha.size() != n_topics)
+    throw std::invalid_argument("alpha must have one element per topic");
+
+  for (auto const& row : type_topic_counts) {
+    if (row.size() != n_topics)
+      throw std::invalid_argument("type topic counts must have one column per topic");
+  }
+
+  std::uint64_t n_chars = 0;
+  for (std::uint64_t type = 0; type < n_types; ++type) {
+    if (alphabet.has(type)) n_chars += alphabet.at(type).size();
+  }
+
+  Header header;
+  std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.n_topics = n_topics;
+  header.n_types = n_types;
+  header.beta = beta;
+  header.alpha_offset = align(sizeof(Header));
+  header.topic_counts_offset = align(header.alpha_offset + n_topics * sizeof(double));
+  header.type_topic_counts_offset = align(header.topic_counts_offset + n_topics * sizeof(Count));
+  header.token_offsets_offset = align(header.type_topic_counts_offset +
+                                      n_types * n_topics * sizeof(uint));
+  header.tokens_offset = header.token_offsets_offset + (n_types + 1) * sizeof(std::uint64_t);
+  header.size = header.tokens_offset + n_chars;
+
+  std::string shm_name = segment_name(name);
+
+  int fd = shm_open(shm_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd == -1)
+    throw std::runtime_error("could not create shared model '" + name + "': " +
+                             std::strerror(errno));
+
+  if (ftruncate(fd, header.size) == -1) {
+    close(fd);
+    shm_unlink(shm_name.c_str());
+    throw std::runtime_error("could not allocate shared model '" + name + "'");
+  }
+
+  void* address = mmap(nullptr, header.size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+
+  if (address == MAP_FAILED) {
+    shm_unlink(shm_name.c_str());
+    throw std::runtime_error("could not map shared model '" + name + "'");
+  }
+
+  char* base = static_cast<char*>(address);
+
+  std::memcpy(base + header.alpha_offset, alpha.data(), n_topics * sizeof(double));
+  std::memcpy(base + header.topic_counts_offset, topic_counts.data(), n_topics * sizeof(Count));
+
+  uint* ttc = reinterpret_cast<uint*>(base + header.type_topic_counts_offset);
+  std::uint64_t* token_offsets = reinterpret_cast<std::uint64_t*>(base + header.token_offsets_offset);
+  char* tokens = base + header.tokens_offset;
+  std::uint64_t offset = 0;
+
+  for (std::uint64_t type = 0; type < n_types; ++type) {
+    const IntVector& row = type_topic_counts.at(type);
+    std::memcpy(ttc + type * n_topics, row.data(), n_topics * sizeof(uint));
+
+    token_offsets[type] = offset;
+    if (alphabet.has(type)) {
+      const Alphabet::Token& token = alphabet.at(type);
+      std::memcpy(tokens + offset, token.data(), token.size());
+      offset += token.size();
+    }
+  }
+  token_offsets[n_types] = offset;
+
+  // The magic is written last so that a partially written segment is never
+  // accepted by attach.
+  Header* mapped = reinterpret_cast<Header*>(base);
+  *mapped = header;
+  std::memset(mapped->magic, 0, sizeof(mapped->magic));
+  __sync_synchronize();
+  std::memcpy(mapped->magic, MAGIC, sizeof(MAGIC));
+
+  munmap(address, header.size);
+}
+
+SharedModel::SPtr SharedModel::attach(const std::string& name) {
+  std::string shm_name = segment_name(name);
+
+  int fd = shm_open(shm_name.c_str(), O_RDONLY, 0);
+  if (fd == -1)
+    throw std::runtime_error("could not attach shared model '" + name + "': " +
+                             std::strerror(errno));
+
+  struct stat st;
+  if (fstat(fd, &st) == -1 || static_cast<std::size_t>(st.st_size) < sizeof(Header)) {
+    close(fd);
+    throw std::runtime_error("shared model '" + name + "' is not valid");
+  }
+
+  void* address = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+
+  if (address == MAP_FAILED)
+    throw std::runtime_error("could not map shared model '" + name + "'");
+
+  const Header* header = static_cast<const Header*>(address);
+  if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 ||
+      header->size > static_cast<std::uint64_t>(st.st_size) ||
+      !is_valid(*header, static_cast<const char*>(address))) {
+    munmap(address, st.st_size);
+    throw std::runtime_error("shared model '" + name + "' is not valid");
+  }
+
+  return SPtr{new SharedModel(address, st.st_size)};
+}
+
+bool SharedModel::is_valid(const Header& header, const char* base) {
+  std::uint64_t size = header.size;
+  std::uint64_t n_topics = header.n_topics;
+  std::uint64_t n_types = header.n_types;
+
+  // n_types is checked before n_types + 1 is formed, and n_topics before
+  // it is multiplied by the size of a count.
+  if (!fits(header.alpha_offset, n_topics, sizeof(double), size) ||
+      !fits(header.topic_counts_offset, n_topics, sizeof(Count), size) ||
+      !fits(header.token_offsets_offset, n_types, sizeof(std::uint64_t), size) ||
+      !fits(header.token_offsets_offset, n_types + 1, sizeof(std::uint64_t), size) ||
+      (n_topics > 0 &&
+       !fits(header.type_topic_counts_offset, n_types, n_topics * sizeof(uint), size)) ||
+      header.tokens_offset > size)
+    return false;
+
+  if (header.alpha_offset % ALIGNMENT != 0 ||
+      header.topic_counts_offset % ALIGNMENT != 0 ||
+      header.type_topic_counts_offset % ALIGNMENT != 0 ||
+      header.token_offsets_offset % sizeof(std::uint64_t) != 0)
+    return false;
+
+  // Every token must lie within the token section.
+  const std::uint64_t* token_offsets =
+    reinterpret_cast<const std::uint64_t*>(base + header.token_offsets_offset);
+  std::uint64_t n_chars = size - header.tokens_offset;
+
+  for (std::uint64_t type = 0; type < n_types; ++type) {
+    if (token_offsets[type] > token_offsets[type + 1]) return false;
+  }
+
+  return token_offsets[n_types] <= n_chars;
+}
+
+bool SharedModel::remove(const std::string& name) {
+  return shm_unlink(segment_name(name).c_str()) == 0;
+}
+
+SharedModel::size_type SharedModel::n_topics() const {
+  return header_->n_topics;
+}
+
+SharedModel::size_type SharedModel::n_types() const {
+  return header_->n_types;
+}
+
+double SharedModel::beta() const {
+  return header_->beta;
+}
+
+const double* SharedModel::alpha() const {
+  return reinterpret_cast<const double*>(at_offset(header_->alpha_offset));
+}
+
+const Count* SharedModel::topic_counts() const {
+  return reinterpret_cast<const Count*>(at_offset(header_->topic_counts_offset));
+}
+
+const uint* SharedModel::type_topic_counts() const {
+  return reinterpret_cast<const uint*>(at_offset(header_->type_topic_counts_offset));
+}
+
+Alphabet SharedModel::alphabet() const {
+  std::map<Alphabet::Token, Alphabet::Type> a{};
+
+  const std::uint64_t* token_offsets =
+    reinterpret_cast<const std::uint64_t*>(at_offset(header_->token_offsets_offset));
+  const char* tokens = at_offset(header_->tokens_offset);
+
+  for (std::uint64_t type = 0; type < header_->n_types; ++type) {
+    std::uint64_t begin = token_offsets[type];
+    std::uint64_t end = token_offsets[type + 1];
+
+    if (begin == end) continue;
+
+    a.insert(std::make_pair(Alphabet::Token(tokens + begin, end - begin), type));
+  }
+
+  return Alphabet{a};
+}
+
+const char* SharedModel::at_offset(std::uint64_t offset) const {
+  return static_cast<const char*>(address_) + offset;
+}
+
+std::string SharedModel::segment_name(const std::string& name) {
+  if (!name.empty() && name.front() == '/') return name;
+  return "/" + name;
+}
@@ -0,0 +1,74 @@
+#ifndef SHARED_MODEL_H
+#define SHARED_MODEL_H
+
+#include <string>
+#include <memory>
+#include <cstdint>
+
+#include "def.h"
+#include "alphabet.h"
+
+// A prepared evaluator model stored in a named POSIX shared-memory segment.
+// One process exports the model, other processes on the same host attach to
+// it read-only and evaluate against the mapped counts without copying them.
+class SharedModel {
+public:
+  using SPtr = std::shared_ptr<const SharedModel>;
+  using size_type = std::size_t;
+
+  ~SharedModel();
+
+  static void create(const std::string& name,
+                     const Alphabet& alphabet,
+                     const DoubleVector& alpha,
+                     double beta,
+                     const CountVector& topic_counts,
+                     const IntMatrix& type_topic_counts);
+  static SPtr attach(const std::string& name);
+  static bool remove(const std::string& name);
+
+  size_type n_topics() const;
+  size_type n_types() const;
+
+  double beta() const;
+  const double* alpha() const;
+
+  const Count* topic_counts() const;
+  const uint* type_topic_counts() const;
+
+  Alphabet alphabet() const;
+
+private:
+  struct Header {
+    char magic[8];
+    std::uint64_t n_topics;
+    std::uint64_t n_types;
+    double beta;
+    std::uint64_t alpha_offset;
+    std::uint64_t topic_counts_offset;
+    std::uint64_t type_topic_counts_offset;
+    std::uint64_t token_offsets_offset;
+    std::uint64_t tokens_offset;
+    std::uint64_t size;
+  };
+
+  void* address_;
+  size_type size_;
+  const Header* header_;
+
+  SharedModel(void* address, size_type size);
+
+  const char* at_offset(std::uint64_t offset) const;
+
+  // Whether every section of the header lies within its size, which attach
+  // has checked against the mapped size.
+  static bool is_valid(const Header& header, const char* base);
+
+  static std::string segment_name(const std::string& name);
+
+  SharedModel(const SharedModel& other) = delete;
+  SharedModel& operator=(const SharedModel& rhs) = delete;
+
+};
+
+#endif // SHARED_MODEL_H
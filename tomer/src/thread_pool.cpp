@@ -0,0 +1,197 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <new>
+#include <stdexcept>
+
+#include "numa.h"
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+
+thread_local bool is_worker = false;
+
+// Linux limits thread names to 15 characters.
+const std::size_t MAX_NAME_LENGTH = 15;
+
+}
+
+ThreadPool::ThreadPool()
+  : size_{0}, cpus_{}, name_{"tomer"}, workers_{}, jobs_{}, mutex_{}, available_{},
+    stopping_{false}
+{
+
+}
+
+ThreadPool::~ThreadPool() {
+  shutdown();
+}
+
+ThreadPool& ThreadPool::get() {
+  static ThreadPool pool;
+#ifdef __linux__
+  static bool registered = pthread_atfork(nullptr, nullptr, [] {
+      ThreadPool::get().reset_after_fork();
+    }) == 0;
+  (void) registered;
+#endif
+  return pool;
+}
+
+void ThreadPool::configure(ThreadPool::size_type size,
+                           const ThreadPool::CpuSet& cpus,
+                           const std::string& name) {
+  if (is_worker)
+    throw std::logic_error("the thread pool cannot be configured from one of its workers");
+
+  for (int cpu : cpus) {
+#ifdef __linux__
+    if (cpu < 0 || cpu >= CPU_SETSIZE)
+#else
+    if (cpu < 0)
+#endif
+      throw std::invalid_argument("invalid CPU " + std::to_string(cpu));
+  }
+
+  shutdown();
+
+  size_ = size;
+  cpus_ = cpus;
+  name_ = name;
+}
+
+void ThreadPool::shutdown() {
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+    if (workers_.empty()) return;
+    stopping_ = true;
+  }
+
+  available_.notify_all();
+  for (auto& worker : workers_) worker.join();
+
+  std::lock_guard<std::mutex> lock{mutex_};
+  workers_.clear();
+  stopping_ = false;
+}
+
+ThreadPool::size_type ThreadPool::size() const {
+  if (size_ > 0) return size_;
+
+  size_type n = std::thread::hardware_concurrency();
+  return n == 0 ? 1 : n;
+}
+
+const ThreadPool::CpuSet& ThreadPool::cpus() const {
+  return cpus_;
+}
+
+const std::string& ThreadPool::name() const {
+  return name_;
+}
+
+bool ThreadPool::running() const {
+  std::lock_guard<std::mutex> lock{mutex_};
+  return !workers_.empty();
+}
+
+void ThreadPool::run(ThreadPool::size_type n_tasks, const ThreadPool::Task& task) {
+  if (n_tasks == 0) return;
+
+  if (n_tasks == 1 || is_worker || size() == 1) {
+    for (size_type i = 0; i < n_tasks; ++i) task(i);
+    return;
+  }
+
+  Latch latch;
+  latch.remaining = n_tasks - 1;
+
+  {
+    std::lock_guard<std::mutex> lock{mutex_};
+    if (workers_.empty()) start();
+
+    for (size_type i = 1; i < n_tasks; ++i)
+      jobs_.push_back(Job{&task, i, &latch});
+  }
+
+  available_.notify_all();
+
+  task(0);
+
+  std::unique_lock<std::mutex> lock{latch.mutex};
+  latch.done.wait(lock, [&latch] { return latch.remaining == 0; });
+}
+
+void ThreadPool::start() {
+  size_type n_workers = size() - 1;
+  workers_.reserve(n_workers);
+
+  for (size_type worker = 0; worker < n_workers; ++worker)
+    workers_.emplace_back(&ThreadPool::work, this, worker);
+}
+
+void ThreadPool::work(ThreadPool::size_type worker) {
+  is_worker = true;
+  setup_worker(worker);
+
+  for (;;) {
+    Job job;
+
+    {
+      std::unique_lock<std::mutex> lock{mutex_};
+      available_.wait(lock, [this] { return stopping_ || !jobs_.empty(); });
+      if (jobs_.empty()) return;
+
+      job = jobs_.front();
+      jobs_.pop_front();
+    }
+
+    {
+      // Tasks may pin their thread, e.g. to a NUMA node, and must not leave
+      // the worker pinned for whatever runs on it next.
+      AffinityGuard guard;
+      (*job.task)(job.index);
+    }
+
+    // The latch lives on the stack of the caller, which may return as soon
+    // as it sees the count reach zero, so it is not touched after unlocking.
+    std::lock_guard<std::mutex> lock{job.latch->mutex};
+    if (--job.latch->remaining == 0) job.latch->done.notify_one();
+  }
+}
+
+void ThreadPool::reset_after_fork() {
+  // Only the forking thread exists in the child. The handles of the workers
+  // are overwritten rather than joined or detached, and the locks are
+  // recreated since they may have been held by a worker at the time of the
+  // fork.
+  for (auto& worker : workers_) new (&worker) std::thread{};
+  workers_.clear();
+  jobs_.clear();
+  stopping_ = false;
+
+  new (&mutex_) std::mutex{};
+  new (&available_) std::condition_variable{};
+}
+
+void ThreadPool::setup_worker(ThreadPool::size_type worker) const {
+#ifdef __linux__
+  std::string suffix = "-" + std::to_string(worker + 1);
+  std::string name = name_.substr(0, MAX_NAME_LENGTH - std::min(suffix.size(), MAX_NAME_LENGTH)) +
+    suffix;
+  pthread_setname_np(pthread_self(), name.c_str());
+
+  if (!cpus_.empty()) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus_) CPU_SET(cpu, &set);
+    sched_setaffinity(0, sizeof(set), &set);
+  }
+#else
+  (void) worker;
+#endif
+}
@@ -0,0 +1,79 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// The process-wide pool of worker threads that all parallel work in the
+// package runs on. Workers are started lazily on first use and kept alive
+// between calls so that short calls do not pay for thread creation. Forked
+// children, e.g. parallel::mclapply workers, start with an empty pool.
+class ThreadPool {
+public:
+  using size_type = std::size_t;
+  using CpuSet = std::vector<int>;
+  using Task = std::function<void(size_type)>;
+
+  ~ThreadPool();
+
+  static ThreadPool& get();
+
+  // Stops the current workers and sets the options used when they are
+  // started again. A size of 0 uses one thread per hardware thread and an
+  // empty CPU set leaves the affinity of the workers alone.
+  void configure(size_type size, const CpuSet& cpus, const std::string& name);
+  void shutdown();
+
+  // Total parallelism including the calling thread.
+  size_type size() const;
+  const CpuSet& cpus() const;
+  const std::string& name() const;
+  bool running() const;
+
+  // Calls task(i) for i in [0, n_tasks), task(0) on the calling thread and
+  // the rest on workers, and returns once all have finished. Tasks must not
+  // throw. Calls made from a worker run all tasks on that worker so that
+  // nested parallel loops cannot deadlock the pool.
+  void run(size_type n_tasks, const Task& task);
+
+private:
+  struct Latch {
+    std::mutex mutex;
+    std::condition_variable done;
+    size_type remaining;
+  };
+
+  struct Job {
+    const Task* task;
+    size_type index;
+    Latch* latch;
+  };
+
+  size_type size_;
+  CpuSet cpus_;
+  std::string name_;
+
+  std::vector<std::thread> workers_;
+  std::deque<Job> jobs_;
+  mutable std::mutex mutex_;
+  std::condition_variable available_;
+  bool stopping_;
+
+  ThreadPool();
+
+  void start();
+  void work(size_type worker);
+  void setup_worker(size_type worker) const;
+  void reset_after_fork();
+
+  ThreadPool(const ThreadPool& other) = delete;
+  ThreadPool& operator=(const ThreadPool& rhs) = delete;
+
+};
+
+#endif // THREAD_POOL_H
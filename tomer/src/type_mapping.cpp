@@ -0,0 +1,57 @@
+#include "type_mapping.h"
+
+#include <stdexcept>
+
+const TypeMapping::CompactType TypeMapping::UNMAPPED;
+
+TypeMapping::TypeMapping(const std::vector<bool>& keep)
+  : map_(keep.size(), UNMAPPED)
+{
+  CompactType next = 0;
+
+  for (size_type type = 0; type < keep.size(); ++type) {
+    if (!keep[type]) continue;
+    if (next == UNMAPPED)
+      throw std::overflow_error("too many types are kept to number them compactly");
+    map_[type] = next++;
+  }
+}
+
+TypeMapping::TypeMapping(const Alphabet& from, const Alphabet& to)
+  : map_{}
+{
+  for (auto const& entry : from) {
+    if (entry.first >= map_.size()) map_.resize(entry.first + 1, UNMAPPED);
+
+    if (!to.has(entry.second)) continue;
+
+    // Model types are narrowed to compact types, of which UNMAPPED is
+    // reserved.
+    Type type = to.at(entry.second);
+    if (type >= UNMAPPED)
+      throw std::overflow_error("type " + std::to_string(type) + " does not fit in a compact type");
+    map_[entry.first] = type;
+  }
+}
+
+bool TypeMapping::has(TypeMapping::Type type) const {
+  return type < map_.size() && map_[type] != UNMAPPED;
+}
+
+TypeMapping::CompactType TypeMapping::at(TypeMapping::Type type) const {
+  return type < map_.size() ? map_[type] : UNMAPPED;
+}
+
+TypeMapping::size_type TypeMapping::size() const {
+  return map_.size();
+}
+
+Alphabet TypeMapping::apply(const Alphabet& alphabet) const {
+  std::map<Alphabet::Token, Alphabet::Type> a{};
+
+  for (auto const& entry : alphabet) {
+    if (has(entry.first)) a.insert(std::make_pair(entry.second, at(entry.first)));
+  }
+
+  return Alphabet{a};
+}
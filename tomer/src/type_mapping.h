@@ -0,0 +1,41 @@
+#ifndef TYPE_MAPPING_H
+#define TYPE_MAPPING_H
+
+#include <limits>
+#include <vector>
+
+#include "def.h"
+#include "alphabet.h"
+#include "type_sequence.h"
+
+// Maps the types of one alphabet onto the types of another. Types without a
+// counterpart are unmapped and are dropped wherever the mapping is applied;
+// between a corpus and a model alphabet they are the out-of-vocabulary types.
+class TypeMapping {
+public:
+  using Type = Alphabet::Type;
+  using CompactType = TypeSequence::CompactType;
+  using size_type = std::size_t;
+
+  static const CompactType UNMAPPED = std::numeric_limits<CompactType>::max();
+
+  // Keeps the types whose flag is set and numbers them consecutively.
+  TypeMapping(const std::vector<bool>& keep);
+  // Maps every type of `from` to the type of the same token in `to`.
+  TypeMapping(const Alphabet& from, const Alphabet& to);
+
+  ~TypeMapping() = default;
+
+  bool has(Type type) const;
+  CompactType at(Type type) const;
+
+  size_type size() const;
+
+  Alphabet apply(const Alphabet& alphabet) const;
+
+private:
+  std::vector<CompactType> map_;
+
+};
+
+#endif // TYPE_MAPPING_H
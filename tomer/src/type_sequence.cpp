@@ -1,19 +1,19 @@
 #include "type_sequence_container.h"
 
-TypeSequence::TypeSequence(const TypeSequence::TypeVector& types, TypeSequence::AlphabetPtr alphabet)
-  : types_{types}, alphabet_{alphabet}
-{
-
-}
+#include <stdexcept>
 
-TypeSequence::TypeSequence(TypeSequence::TypeVector&& types, TypeSequence::AlphabetPtr alphabet)
-  : types_{std::move(types)}, alphabet_{alphabet}
+TypeSequence::TypeSequence(const TypeSequence::CompactType* types,
+                           TypeSequence::size_type length,
+                           const Alphabet* alphabet)
+  : types_{types}, length_{length}, alphabet_{alphabet}
 {
 
 }
 
-const TypeSequence::Type& TypeSequence::at(TypeSequence::size_type position) const {
-  return types_.at(position);
+TypeSequence::Type TypeSequence::at(TypeSequence::size_type position) const {
+  if (position >= length_)
+    throw std::out_of_range("TypeSequence::at");
+  return types_[position];
 }
 
 const TypeSequence::Token& TypeSequence::token_at(TypeSequence::size_type position) const {
@@ -22,7 +22,7 @@ const TypeSequence::Token& TypeSequence::token_at(TypeSequence::size_type positi
 }
 
 TypeSequence::size_type TypeSequence::size() const {
-  return types_.size();
+  return length_;
 }
 
 TypeSequence::size_type TypeSequence::length() const {
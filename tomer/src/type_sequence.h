@@ -2,18 +2,21 @@
 #define TYPE_SEQUENCE_H
 
 #include <vector>
+#include <cstdint>
 
 #include "alphabet.h"
 
-class TypeSequenceBuilder;
+class TypeSequenceContainer;
 
+// A read-only view of one document in the flat type buffer of a
+// TypeSequenceContainer. Types are stored as 32-bit integers to keep the
+// per-token data compact, lengths and positions are 64-bit.
 class TypeSequence {
 public:
   using Type = Alphabet::Type;
-  using TypeVector = std::vector<Type>;
+  using CompactType = std::uint32_t;
   using Token = Alphabet::Token;
-  using AlphabetPtr = Alphabet::SPtr;
-  using size_type = TypeVector::size_type;
+  using size_type = std::size_t;
 
   TypeSequence(const TypeSequence& other) = default;
   TypeSequence(TypeSequence&& other) = default;
@@ -23,20 +26,21 @@ public:
   TypeSequence& operator=(const TypeSequence& rhs) = default;
   TypeSequence& operator=(TypeSequence&& rhs) = default;
 
-  const Type& at(size_type position) const;
+  Type at(size_type position) const;
   const Token& token_at(size_type position) const;
 
   size_type size() const;
   size_type length() const;
 
 private:
-  TypeVector types_;
-  AlphabetPtr alphabet_;
+  const CompactType* types_;
+  size_type length_;
+  const Alphabet* alphabet_;
 
-  TypeSequence(const TypeVector& types, AlphabetPtr alphabet);
-  TypeSequence(TypeVector&& types, AlphabetPtr alphabet);
+  TypeSequence(const CompactType* types, size_type length, const Alphabet* alphabet);
 
-  friend class TypeSequenceBuilder;
+  friend class TypeSequenceContainer;
+  friend class TypeSequenceView;
 
 };
 
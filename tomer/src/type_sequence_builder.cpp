@@ -1,21 +1,34 @@
 #include "type_sequence_builder.h"
 
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+#include "parallel.h"
 #include "type_sequence.h"
 
+namespace {
+
+// Fewest tokens worth a chunk of their own in the counting sort.
+const std::size_t MIN_TOKENS_PER_CHUNK = 1 << 16;
+
+}
+
 TypeSequenceBuilder::TypeSequenceBuilder()
-  : container_{}, alphabet_{std::make_shared<Alphabet>(Alphabet())}, fixed_{false}
+  : alphabet_{std::make_shared<Alphabet>(Alphabet())}, container_{alphabet_}, fixed_{false}
 {
 
 }
 
 TypeSequenceBuilder::TypeSequenceBuilder(const Alphabet& alphabet, bool fixed)
-  : container_{}, alphabet_{std::make_shared<Alphabet>(Alphabet{alphabet})}, fixed_{fixed}
+  : alphabet_{std::make_shared<Alphabet>(Alphabet{alphabet})}, container_{alphabet_}, fixed_{fixed}
 {
 
 }
 
 TypeSequenceBuilder::TypeSequenceBuilder(Alphabet&& alphabet, bool fixed)
-  : container_{}, alphabet_{std::make_shared<Alphabet>(Alphabet{std::move(alphabet)})}, fixed_{fixed}
+  : alphabet_{std::make_shared<Alphabet>(Alphabet{std::move(alphabet)})}, container_{alphabet_}, fixed_{fixed}
 {
 
 }
@@ -32,8 +45,94 @@ void TypeSequenceBuilder::add(const Document& document) {
   else
     types = create_type_vector_and_update_alphabet(document);
 
-  TypeSequence ts{std::move(types), alphabet_};
-  container_.add(ts);
+  container_.add(types);
+}
+
+void TypeSequenceBuilder::add(const TypeSequenceBuilder::TypeVector& types,
+                              const TypeSequenceBuilder::DocumentVector& documents,
+                              std::size_t n_documents,
+                              std::size_t n_threads) {
+  if (types.size() != documents.size())
+    throw std::invalid_argument("every token needs a document");
+
+  if (n_threads == 0) n_threads = default_n_threads();
+
+  std::size_t n_tokens = types.size();
+  std::size_t n_chunks = std::max<std::size_t>(1, std::min(n_threads,
+                                                           n_tokens / MIN_TOKENS_PER_CHUNK));
+  std::size_t chunk_size = (n_tokens + n_chunks - 1) / n_chunks;
+
+  auto chunk_begin = [&](std::size_t chunk) { return std::min(chunk * chunk_size, n_tokens); };
+
+  // counts[chunk][document] is first the number of tokens of the document in
+  // the chunk and then the position the next of them is written to.
+  std::vector<TypeSequenceContainer::Offsets> counts(n_chunks);
+
+  parallel_for(0, n_chunks, n_chunks, [&](std::size_t chunk, std::size_t) {
+    TypeSequenceContainer::Offsets& count = counts[chunk];
+    count.assign(n_documents, 0);
+
+    for (std::size_t i = chunk_begin(chunk); i < chunk_begin(chunk + 1); ++i) {
+      if (documents[i] >= n_documents)
+        throw std::out_of_range("document index out of range");
+      ++count[documents[i]];
+    }
+  });
+
+  std::size_t position = container_.types_.size();
+  container_.types_.resize(position + n_tokens);
+  container_.offsets_.reserve(container_.offsets_.size() + n_documents);
+
+  for (std::size_t document = 0; document < n_documents; ++document) {
+    for (std::size_t chunk = 0; chunk < n_chunks; ++chunk) {
+      std::size_t count = counts[chunk][document];
+      counts[chunk][document] = position;
+      position += count;
+    }
+    container_.offsets_.push_back(position);
+  }
+
+  parallel_for(0, n_chunks, n_chunks, [&](std::size_t chunk, std::size_t) {
+    TypeSequenceContainer::Offsets& next = counts[chunk];
+
+    for (std::size_t i = chunk_begin(chunk); i < chunk_begin(chunk + 1); ++i) {
+      container_.types_[next[documents[i]]++] = types[i];
+    }
+  });
+}
+
+void TypeSequenceBuilder::add(TypeSequenceBuilder::TypeVector&& types,
+                              const std::vector<std::size_t>& lengths) {
+  std::size_t n_tokens = std::accumulate(lengths.cbegin(), lengths.cend(), std::size_t{0});
+
+  if (types.size() != n_tokens)
+    throw std::invalid_argument("document lengths do not add up to the number of tokens");
+
+  std::size_t position = container_.types_.size();
+
+  if (position == 0)
+    container_.types_ = std::move(types);
+  else
+    container_.types_.insert(container_.types_.end(), types.cbegin(), types.cend());
+
+  container_.offsets_.reserve(container_.offsets_.size() + lengths.size());
+  for (std::size_t length : lengths) {
+    position += length;
+    container_.offsets_.push_back(position);
+  }
+}
+
+bool TypeSequenceBuilder::encode(const TypeSequenceBuilder::Token& token,
+                                 TypeSequenceBuilder::CompactType& type) {
+  if (!fixed_) {
+    type = compact(alphabet_->add(token));
+    return true;
+  }
+
+  if (!alphabet_->has(token)) return false;
+
+  type = compact(alphabet_->at(token));
+  return true;
 }
 
 const TypeSequenceContainer& TypeSequenceBuilder::get_data() const {
@@ -42,13 +141,15 @@ const TypeSequenceContainer& TypeSequenceBuilder::get_data() const {
 
 TypeSequenceBuilder::TypeVector
 TypeSequenceBuilder::create_type_vector(const Document& document) {
-  TypeSequenceBuilder::TypeVector types(document.size());
+  TypeSequenceBuilder::TypeVector types;
   TypeSequenceBuilder::Type type;
 
+  types.reserve(document.size());
+
   for (auto const& token : document) {
     if (alphabet_->has(token)) {
       type = alphabet_->at(token);
-      types.push_back(type);
+      types.push_back(compact(type));
     }
   }
 
@@ -57,13 +158,23 @@ TypeSequenceBuilder::create_type_vector(const Document& document) {
 
 TypeSequenceBuilder::TypeVector
 TypeSequenceBuilder::create_type_vector_and_update_alphabet(const Document& document) {
-  TypeSequenceBuilder::TypeVector types(document.size());
+  TypeSequenceBuilder::TypeVector types;
   TypeSequenceBuilder::Type type;
 
+  types.reserve(document.size());
+
   for (auto const& token : document) {
     type = alphabet_->add(token);
-    types.push_back(type);
+    types.push_back(compact(type));
   }
 
   return types;
 }
+
+// The largest compact type is reserved, as the unmapped type of TypeMapping
+// and the unknown token of encoded R corpora.
+TypeSequenceBuilder::CompactType TypeSequenceBuilder::compact(TypeSequenceBuilder::Type type) {
+  if (type >= std::numeric_limits<CompactType>::max())
+    throw std::overflow_error("type does not fit in a compact type sequence");
+  return static_cast<CompactType>(type);
+}
@@ -1,15 +1,20 @@
 #ifndef TYPE_SEQUENCE_BUILDER_H
 #define TYPE_SEQUENCE_BUILDER_H
 
+#include <vector>
+
 #include "def.h"
 #include "alphabet.h"
 #include "type_sequence_container.h"
 
 class TypeSequenceBuilder {
 public:
+  using Token = Alphabet::Token;
   using Type = Alphabet::Type;
-  using TypeVector = std::vector<Type>;
+  using CompactType = TypeSequenceContainer::CompactType;
+  using TypeVector = TypeSequenceContainer::CompactTypeVector;
   using AlphabetPtr = Alphabet::SPtr;
+  using DocumentVector = std::vector<std::size_t>;
 
   TypeSequenceBuilder();
   TypeSequenceBuilder(const Alphabet& alphabet, bool fixed);
@@ -20,16 +25,35 @@ public:
   void add(const Corpus& corpus);
   void add(const Document& document);
 
+  // Adds the tokens of n_documents documents that are given in any order:
+  // types[i] belongs to document documents[i]. Tokens are grouped with a
+  // parallel, stable counting sort so they keep their order within each
+  // document, and documents without tokens are added empty.
+  void add(const TypeVector& types,
+           const DocumentVector& documents,
+           std::size_t n_documents,
+           std::size_t n_threads);
+
+  // Adds documents whose types are stored back to back, the i-th document
+  // with lengths[i] tokens.
+  void add(TypeVector&& types, const std::vector<std::size_t>& lengths);
+
+  // Looks up the type of a token, adding it to the alphabet unless the
+  // alphabet is fixed. Returns false for tokens outside a fixed alphabet.
+  bool encode(const Token& token, CompactType& type);
+
   const TypeSequenceContainer& get_data() const;
 
 private:
-  TypeSequenceContainer container_;
   AlphabetPtr alphabet_;
+  TypeSequenceContainer container_;
   bool fixed_;
 
   TypeVector create_type_vector(const Document& document);
   TypeVector create_type_vector_and_update_alphabet(const Document& document);
 
+  static CompactType compact(Type type);
+
   TypeSequenceBuilder(const TypeSequenceBuilder& other) = delete;
   TypeSequenceBuilder(TypeSequenceBuilder&& other) = delete;
 
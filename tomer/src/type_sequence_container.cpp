@@ -1,17 +1,119 @@
 #include "type_sequence_container.h"
 
-void TypeSequenceContainer::add(const TypeSequence& type_sequence) {
-  types_.push_back(type_sequence);
+#include <algorithm>
+#include <stdexcept>
+
+#include "parallel.h"
+#include "type_mapping.h"
+
+namespace {
+
+const std::size_t DOCUMENT_GRAIN = 256;
+
+}
+
+TypeSequenceContainer::TypeSequenceContainer(TypeSequenceContainer::AlphabetPtr alphabet)
+  : types_{}, offsets_{0}, alphabet_{alphabet}, generation_{0}
+{
+
 }
 
-void TypeSequenceContainer::add(TypeSequence&& type_sequence) {
-  types_.push_back(std::move(type_sequence));
+void TypeSequenceContainer::add(const TypeSequenceContainer::CompactTypeVector& types) {
+  types_.insert(types_.end(), types.cbegin(), types.cend());
+  offsets_.push_back(types_.size());
 }
 
-const TypeSequence& TypeSequenceContainer::at(TypeSequenceContainer::size_type position) const {
-  return types_.at(position);
+TypeSequence TypeSequenceContainer::at(TypeSequenceContainer::size_type position) const {
+  if (position >= size())
+    throw std::out_of_range("TypeSequenceContainer::at");
+
+  std::size_t begin = offsets_[position];
+  std::size_t end = offsets_[position + 1];
+
+  return TypeSequence{types_.data() + begin, end - begin, alphabet_.get()};
 }
 
 TypeSequenceContainer::size_type TypeSequenceContainer::size() const {
+  return offsets_.size() - 1;
+}
+
+TypeSequenceContainer::size_type TypeSequenceContainer::n_tokens() const {
   return types_.size();
 }
+
+const Alphabet& TypeSequenceContainer::alphabet() const {
+  return *alphabet_;
+}
+
+const TypeSequenceContainer::AlphabetPtr& TypeSequenceContainer::shared_alphabet() const {
+  return alphabet_;
+}
+
+const TypeSequenceContainer::CompactType* TypeSequenceContainer::data() const {
+  return types_.data();
+}
+
+const TypeSequenceContainer::Offsets& TypeSequenceContainer::offsets() const {
+  return offsets_;
+}
+
+CountVector TypeSequenceContainer::type_frequencies(std::size_t n_threads) const {
+  if (n_threads == 0) n_threads = default_n_threads();
+
+  std::size_t n_types = 0;
+  for (auto const& entry : *alphabet_) n_types = std::max(n_types, entry.first + 1);
+
+  std::vector<CountVector> local(n_threads);
+
+  parallel_for(0, size(), n_threads, [&](std::size_t doc, std::size_t thread) {
+    CountVector& counts = local[thread];
+    if (counts.empty()) counts.resize(n_types, 0);
+
+    for (std::size_t i = offsets_[doc]; i < offsets_[doc + 1]; ++i) ++counts[types_[i]];
+  }, DOCUMENT_GRAIN);
+
+  CountVector frequencies(n_types, 0);
+  for (auto const& counts : local) {
+    for (std::size_t type = 0; type < counts.size(); ++type) frequencies[type] += counts[type];
+  }
+
+  return frequencies;
+}
+
+void TypeSequenceContainer::remap(const TypeMapping& mapping, std::size_t n_threads) {
+  std::size_t n_docs = size();
+  Offsets lengths(n_docs);
+
+  // Every document is remapped and compacted within its own range first...
+  parallel_for(0, n_docs, n_threads, [&](std::size_t doc, std::size_t) {
+    std::size_t out = offsets_[doc];
+
+    for (std::size_t i = offsets_[doc]; i < offsets_[doc + 1]; ++i) {
+      CompactType type = mapping.at(types_[i]);
+      if (type != TypeMapping::UNMAPPED) types_[out++] = type;
+    }
+
+    lengths[doc] = out - offsets_[doc];
+  }, DOCUMENT_GRAIN);
+
+  // ...then the documents are moved down to close the gaps.
+  std::size_t end = 0;
+  for (std::size_t doc = 0; doc < n_docs; ++doc) {
+    std::size_t begin = offsets_[doc];
+    std::move(types_.begin() + begin, types_.begin() + begin + lengths[doc], types_.begin() + end);
+
+    offsets_[doc] = end;
+    end += lengths[doc];
+  }
+  offsets_[n_docs] = end;
+
+  types_.resize(end);
+  types_.shrink_to_fit();
+
+  alphabet_ = std::make_shared<Alphabet>(mapping.apply(*alphabet_));
+  ++generation_;
+}
+
+TypeSequenceContainer::size_type TypeSequenceContainer::generation() const {
+  return generation_;
+}
@@ -1,14 +1,22 @@
 #ifndef TYPE_SEQUENCE_CONTAINER_H
 #define TYPE_SEQUENCE_CONTAINER_H
 
+#include "def.h"
 #include "type_sequence.h"
 
 class TypeSequenceBuilder;
+class TypeMapping;
 
+// Stores all documents back to back in one flat buffer of compact types.
+// Document boundaries are kept as 64-bit offsets into that buffer so the
+// container is not limited to 2^32 tokens.
 class TypeSequenceContainer {
 public:
-  using TypeSequences = std::vector<TypeSequence>;
-  using size_type = TypeSequences::size_type;
+  using CompactType = TypeSequence::CompactType;
+  using CompactTypeVector = std::vector<CompactType>;
+  using Offsets = std::vector<std::size_t>;
+  using AlphabetPtr = Alphabet::SPtr;
+  using size_type = std::size_t;
 
   TypeSequenceContainer(const TypeSequenceContainer& other) = default;
   TypeSequenceContainer(TypeSequenceContainer&& other) = default;
@@ -18,17 +26,39 @@ public:
   TypeSequenceContainer& operator=(const TypeSequenceContainer& rhs) = default;
   TypeSequenceContainer& operator=(TypeSequenceContainer&& rhs) = default;
 
-  const TypeSequence& at(size_type position) const;
+  TypeSequence at(size_type position) const;
 
   size_type size() const;
+  size_type n_tokens() const;
+
+  const Alphabet& alphabet() const;
+  const AlphabetPtr& shared_alphabet() const;
+
+  // The types of all documents back to back, and the offset of every
+  // document followed by the number of tokens.
+  const CompactType* data() const;
+  const Offsets& offsets() const;
+
+  // Number of occurrences of every type of the alphabet.
+  CountVector type_frequencies(std::size_t n_threads) const;
+
+  // Replaces every type by its mapped type and drops unmapped tokens. The
+  // alphabet is replaced by the mapped alphabet.
+  void remap(const TypeMapping& mapping, std::size_t n_threads);
+
+  // Number of times the container has been remapped, by which views tell
+  // that the types they select have changed.
+  size_type generation() const;
 
 private:
-  TypeSequences types_;
+  CompactTypeVector types_;
+  Offsets offsets_;
+  AlphabetPtr alphabet_;
+  size_type generation_;
 
-  TypeSequenceContainer() = default;
+  TypeSequenceContainer(AlphabetPtr alphabet);
 
-  void add(const TypeSequence& ts);
-  void add(TypeSequence&& ts);
+  void add(const CompactTypeVector& types);
 
   friend class TypeSequenceBuilder;
 
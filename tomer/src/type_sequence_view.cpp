@@ -0,0 +1,115 @@
+#include "type_sequence_view.h"
+
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+TypeSequenceView::TypeSequenceView(const TypeSequenceContainer& container)
+  : container_{&container}, container_generation_{container.generation()},
+    first_{0}, size_{container.size()}, spans_{}, n_tokens_{container.n_tokens()}
+{
+
+}
+
+TypeSequenceView::TypeSequenceView(const TypeSequenceContainer* container,
+                                   TypeSequenceView::size_type container_generation,
+                                   std::vector<TypeSequenceView::Span>&& spans)
+  : container_{container}, container_generation_{container_generation},
+    first_{0}, size_{spans.size()}, spans_{std::move(spans)}, n_tokens_{0}
+{
+  for (auto const& span : spans_) n_tokens_ += span.end - span.begin;
+}
+
+bool TypeSequenceView::is_contiguous() const {
+  return spans_.empty();
+}
+
+TypeSequenceView::Span TypeSequenceView::span(TypeSequenceView::size_type position) const {
+  if (!is_contiguous()) return spans_[position];
+
+  const TypeSequenceContainer::Offsets& offsets = container_->offsets();
+  return Span{offsets[first_ + position], offsets[first_ + position + 1]};
+}
+
+TypeSequence TypeSequenceView::at(TypeSequenceView::size_type position) const {
+  if (position >= size_)
+    throw std::out_of_range("TypeSequenceView::at");
+
+  Span s = span(position);
+  return TypeSequence{container_->data() + s.begin, s.end - s.begin, &container_->alphabet()};
+}
+
+TypeSequenceView::size_type TypeSequenceView::size() const {
+  return size_;
+}
+
+TypeSequenceView::size_type TypeSequenceView::n_tokens() const {
+  if (!is_contiguous()) return n_tokens_;
+
+  const TypeSequenceContainer::Offsets& offsets = container_->offsets();
+  return offsets[first_ + size_] - offsets[first_];
+}
+
+const Alphabet& TypeSequenceView::alphabet() const {
+  return container_->alphabet();
+}
+
+const TypeSequenceContainer& TypeSequenceView::container() const {
+  return *container_;
+}
+
+bool TypeSequenceView::is_stale() const {
+  return container_->generation() != container_generation_;
+}
+
+TypeSequenceView TypeSequenceView::subset(const std::vector<TypeSequenceView::size_type>& positions) const {
+  std::vector<Span> spans;
+  spans.reserve(positions.size());
+
+  for (auto position : positions) {
+    if (position >= size_)
+      throw std::out_of_range("document " + std::to_string(position) + " is not in the corpus");
+
+    spans.push_back(span(position));
+  }
+
+  return TypeSequenceView{container_, container_generation_, std::move(spans)};
+}
+
+TypeSequenceView TypeSequenceView::shard(TypeSequenceView::size_type begin,
+                                         TypeSequenceView::size_type end) const {
+  if (begin > end || end > size_)
+    throw std::out_of_range("documents [" + std::to_string(begin) + ", " + std::to_string(end) +
+                            ") are not in the corpus");
+
+  if (!is_contiguous()) {
+    std::vector<Span> spans(spans_.cbegin() + begin, spans_.cbegin() + end);
+    return TypeSequenceView{container_, container_generation_, std::move(spans)};
+  }
+
+  TypeSequenceView view{*this};
+  view.first_ = first_ + begin;
+  view.size_ = end - begin;
+  return view;
+}
+
+TypeSequenceView TypeSequenceView::token_range(double from, double to) const {
+  if (!(from >= 0 && from <= to && to <= 1))
+    throw std::invalid_argument("token ranges must satisfy 0 <= from <= to <= 1");
+
+  std::vector<Span> spans;
+  spans.reserve(size_);
+
+  for (size_type position = 0; position < size_; ++position) {
+    Span s = span(position);
+    double length = s.end - s.begin;
+
+    // Rounding both ends the same way makes adjacent ranges partition the
+    // document.
+    size_type begin = s.begin + static_cast<size_type>(std::floor(from * length + 0.5));
+    size_type end = s.begin + static_cast<size_type>(std::floor(to * length + 0.5));
+    spans.push_back(Span{begin, end});
+  }
+
+  return TypeSequenceView{container_, container_generation_, std::move(spans)};
+}
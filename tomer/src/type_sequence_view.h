@@ -0,0 +1,80 @@
+#ifndef TYPE_SEQUENCE_VIEW_H
+#define TYPE_SEQUENCE_VIEW_H
+
+#include <vector>
+
+#include "def.h"
+#include "type_sequence.h"
+#include "type_sequence_container.h"
+
+// A read-only selection of the documents of a TypeSequenceContainer that
+// shares its type buffer. A view is either a contiguous range of whole
+// documents, which costs nothing, or a list of token ranges into the buffer,
+// one per document. Views are made from views, so subsets, shards and token
+// ranges compose, and every estimator takes a view, to which a container
+// converts as a whole.
+//
+// The container must outlive the view and must not be remapped while it is
+// in use.
+class TypeSequenceView {
+public:
+  using size_type = std::size_t;
+
+  TypeSequenceView(const TypeSequenceContainer& container);
+
+  TypeSequenceView(const TypeSequenceView& other) = default;
+  TypeSequenceView(TypeSequenceView&& other) = default;
+
+  ~TypeSequenceView() = default;
+
+  TypeSequenceView& operator=(const TypeSequenceView& rhs) = default;
+  TypeSequenceView& operator=(TypeSequenceView&& rhs) = default;
+
+  TypeSequence at(size_type position) const;
+
+  size_type size() const;
+  size_type n_tokens() const;
+
+  const Alphabet& alphabet() const;
+  const TypeSequenceContainer& container() const;
+
+  // Whether the container has been remapped since the view was made.
+  bool is_stale() const;
+
+  // The documents at the given positions, in that order. Positions may
+  // repeat, as in bootstrap samples.
+  TypeSequenceView subset(const std::vector<size_type>& positions) const;
+
+  // The documents in [begin, end).
+  TypeSequenceView shard(size_type begin, size_type end) const;
+
+  // The tokens of every document from the fraction from to the fraction to
+  // of its length, e.g. (0, 0.5) and (0.5, 1) for its two halves.
+  TypeSequenceView token_range(double from, double to) const;
+
+private:
+  struct Span {
+    size_type begin;
+    size_type end;
+  };
+
+  const TypeSequenceContainer* container_;
+  size_type container_generation_;
+
+  // Either the range of whole documents [first_, first_ + size_) of the
+  // container, or spans_ if it is not empty.
+  size_type first_;
+  size_type size_;
+  std::vector<Span> spans_;
+  size_type n_tokens_;
+
+  TypeSequenceView(const TypeSequenceContainer* container,
+                   size_type container_generation,
+                   std::vector<Span>&& spans);
+
+  bool is_contiguous() const;
+  Span span(size_type position) const;
+
+};
+
+#endif // TYPE_SEQUENCE_VIEW_H
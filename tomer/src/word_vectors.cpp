@@ -0,0 +1,399 @@
+#include "word_vectors.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <numeric>
+#include <sstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+
+#include "parallel.h"
+
+namespace {
+
+const char MAGIC[8] = {'T', 'O', 'M', 'E', 'R', 'W', 'V', '1'};
+const std::uint64_t ALIGNMENT = 64;
+const std::uint64_t FLOATS_PER_BLOCK = 16;
+
+std::uint64_t align(std::uint64_t offset, std::uint64_t alignment) {
+  return (offset + alignment - 1) / alignment * alignment;
+}
+
+// Dot products of a with each of b[0], ..., b[3]. All vectors are aligned
+// and their length is a multiple of FLOATS_PER_BLOCK.
+void dot4(const float* a, const float* const* b, std::size_t length, double* dots) {
+#ifdef __SSE__
+  __m128 sums[4] = {_mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps()};
+
+  for (std::size_t k = 0; k < length; k += 4) {
+    __m128 x = _mm_load_ps(a + k);
+    for (int i = 0; i < 4; ++i) sums[i] = _mm_add_ps(sums[i], _mm_mul_ps(x, _mm_load_ps(b[i] + k)));
+  }
+
+  for (int i = 0; i < 4; ++i) {
+    float lanes[4];
+    _mm_storeu_ps(lanes, sums[i]);
+    dots[i] = static_cast<double>(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+  }
+#else
+  for (int i = 0; i < 4; ++i) {
+    float sum = 0;
+    for (std::size_t k = 0; k < length; ++k) sum += a[k] * b[i][k];
+    dots[i] = sum;
+  }
+#endif
+}
+
+// Whether n elements of element_size bytes starting at offset lie within the
+// first size bytes. Divides instead of multiplying so that corrupt counts
+// cannot overflow.
+bool fits(std::uint64_t offset, std::uint64_t n, std::uint64_t element_size, std::uint64_t size) {
+  return offset <= size && n <= (size - offset) / element_size;
+}
+
+double dot(const float* a, const float* b, std::size_t length) {
+  float sum = 0;
+  for (std::size_t k = 0; k < length; ++k) sum += a[k] * b[k];
+  return sum;
+}
+
+// Collects the converted vectors: normalizes and pads each one and streams
+// it to the output, keeping only the tokens in memory.
+class VectorWriter {
+public:
+  VectorWriter(std::ofstream& out, std::uint64_t offset)
+    : out_(out), offset_{offset}, dimension_{0}, stride_{0}, padded_{}, tokens_{}
+  {}
+
+  void set_dimension(std::uint64_t dimension) {
+    if (dimension == 0)
+      throw std::runtime_error("word vectors must have at least one dimension");
+
+    dimension_ = dimension;
+    stride_ = align(dimension, FLOATS_PER_BLOCK);
+    padded_.assign(stride_, 0.0f);
+  }
+
+  void add(const std::string& token, const float* values) {
+    double norm = 0;
+    for (std::uint64_t k = 0; k < dimension_; ++k) norm += static_cast<double>(values[k]) * values[k];
+    norm = std::sqrt(norm);
+
+    for (std::uint64_t k = 0; k < dimension_; ++k) padded_[k] = norm > 0 ? values[k] / norm : 0.0f;
+
+    out_.write(reinterpret_cast<const char*>(padded_.data()), stride_ * sizeof(float));
+    tokens_.push_back(token);
+  }
+
+  std::uint64_t dimension() const { return dimension_; }
+  std::uint64_t stride() const { return stride_; }
+  std::uint64_t offset() const { return offset_; }
+  const std::vector<std::string>& tokens() const { return tokens_; }
+
+private:
+  std::ofstream& out_;
+  std::uint64_t offset_;
+  std::uint64_t dimension_;
+  std::uint64_t stride_;
+  std::vector<float> padded_;
+  std::vector<std::string> tokens_;
+};
+
+void read_word2vec(std::ifstream& in, VectorWriter& writer) {
+  std::uint64_t n_words;
+  std::uint64_t dimension;
+
+  if (!(in >> n_words >> dimension))
+    throw std::runtime_error("word2vec file has no header");
+
+  writer.set_dimension(dimension);
+  std::vector<float> values(dimension);
+
+  for (std::uint64_t i = 0; i < n_words; ++i) {
+    std::string token;
+    int c;
+
+    while ((c = in.get()) == ' ' || c == '\n' || c == '\r') {}
+    while (c != EOF && c != ' ') {
+      token.push_back(static_cast<char>(c));
+      c = in.get();
+    }
+
+    in.read(reinterpret_cast<char*>(values.data()), dimension * sizeof(float));
+    if (!in || token.empty())
+      throw std::runtime_error("word2vec file ends after " + std::to_string(i) + " words");
+
+    writer.add(token, values.data());
+  }
+}
+
+void read_text(std::ifstream& in, VectorWriter& writer) {
+  std::string line;
+  std::vector<float> values;
+  bool first = true;
+
+  while (std::getline(in, line)) {
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    if (line.find_first_not_of(" \t") == std::string::npos) continue;
+
+    std::istringstream ss{line};
+    std::string token;
+    ss >> token;
+
+    values.clear();
+    float value;
+    while (ss >> value) values.push_back(value);
+
+    if (!ss.eof())
+      throw std::runtime_error("malformed word vector line for '" + token + "'");
+
+    // fastText starts with a "<n> <dimension>" header line.
+    if (first) {
+      first = false;
+      if (values.size() == 1 && token.find_first_not_of("0123456789") == std::string::npos)
+        continue;
+    }
+
+    if (writer.dimension() == 0) writer.set_dimension(values.size());
+
+    if (values.size() != writer.dimension())
+      throw std::runtime_error("word vector of '" + token + "' has " +
+                               std::to_string(values.size()) + " instead of " +
+                               std::to_string(writer.dimension()) + " dimensions");
+
+    writer.add(token, values.data());
+  }
+}
+
+}
+
+const std::int64_t WordVectors::NONE;
+
+WordVectors::WordVectors(void* mapping, WordVectors::size_type size)
+  : mapping_{mapping}, mapping_size_{size}
+{
+  const char* base = static_cast<const char*>(mapping);
+
+  header_ = static_cast<const Header*>(mapping);
+  vectors_ = reinterpret_cast<const float*>(base + header_->vectors_offset);
+  sorted_rows_ = reinterpret_cast<const std::uint64_t*>(base + header_->sorted_rows_offset);
+  token_offsets_ = reinterpret_cast<const std::uint64_t*>(base + header_->token_offsets_offset);
+  tokens_ = base + header_->tokens_offset;
+}
+
+WordVectors::~WordVectors() {
+  munmap(mapping_, mapping_size_);
+}
+
+void WordVectors::convert(const std::string& input, const std::string& output, WordVectors::Format format) {
+  std::ifstream in{input, std::ios::binary};
+  if (!in)
+    throw std::runtime_error("could not open '" + input + "'");
+
+  std::ofstream out{output, std::ios::binary | std::ios::trunc};
+  if (!out)
+    throw std::runtime_error("could not create '" + output + "'");
+
+  Header header;
+  std::memset(&header, 0, sizeof(Header));
+  header.vectors_offset = align(sizeof(Header), ALIGNMENT);
+
+  std::string padding(header.vectors_offset, '\0');
+  out.write(padding.data(), padding.size());
+
+  VectorWriter writer{out, header.vectors_offset};
+
+  if (format == Format::WORD2VEC)
+    read_word2vec(in, writer);
+  else
+    read_text(in, writer);
+
+  const std::vector<std::string>& tokens = writer.tokens();
+  std::uint64_t n_words = tokens.size();
+
+  std::vector<std::uint64_t> sorted_rows(n_words);
+  std::iota(sorted_rows.begin(), sorted_rows.end(), 0);
+  std::stable_sort(sorted_rows.begin(), sorted_rows.end(), [&tokens](std::uint64_t a, std::uint64_t b) {
+      return tokens[a] < tokens[b];
+    });
+
+  std::vector<std::uint64_t> token_offsets(n_words + 1, 0);
+  for (std::uint64_t row = 0; row < n_words; ++row) {
+    token_offsets[row + 1] = token_offsets[row] + tokens[row].size();
+  }
+
+  std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.n_words = n_words;
+  header.dimension = writer.dimension();
+  header.stride = writer.stride();
+  header.sorted_rows_offset = header.vectors_offset + n_words * header.stride * sizeof(float);
+  header.token_offsets_offset = header.sorted_rows_offset + n_words * sizeof(std::uint64_t);
+  header.tokens_offset = header.token_offsets_offset + (n_words + 1) * sizeof(std::uint64_t);
+  header.size = header.tokens_offset + token_offsets.back();
+
+  out.write(reinterpret_cast<const char*>(sorted_rows.data()), n_words * sizeof(std::uint64_t));
+  out.write(reinterpret_cast<const char*>(token_offsets.data()), (n_words + 1) * sizeof(std::uint64_t));
+  for (auto const& token : tokens) out.write(token.data(), token.size());
+
+  out.seekp(0);
+  out.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+
+  if (!out)
+    throw std::runtime_error("could not write '" + output + "'");
+}
+
+WordVectors::SPtr WordVectors::open(const std::string& path) {
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd == -1)
+    throw std::runtime_error("could not open word vectors '" + path + "': " + std::strerror(errno));
+
+  struct stat st;
+  if (fstat(fd, &st) == -1 || static_cast<std::size_t>(st.st_size) < sizeof(Header)) {
+    close(fd);
+    throw std::runtime_error("'" + path + "' is not a word vector file");
+  }
+
+  void* address = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+
+  if (address == MAP_FAILED)
+    throw std::runtime_error("could not map word vectors '" + path + "'");
+
+  const Header* header = static_cast<const Header*>(address);
+  if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 ||
+      header->size > static_cast<std::uint64_t>(st.st_size) ||
+      !is_valid(*header, static_cast<const char*>(address))) {
+    munmap(address, st.st_size);
+    throw std::runtime_error("'" + path + "' is not a word vector file");
+  }
+
+  return SPtr{new WordVectors(address, st.st_size)};
+}
+
+bool WordVectors::is_valid(const Header& header, const char* base) {
+  std::uint64_t size = header.size;
+  std::uint64_t n_words = header.n_words;
+  std::uint64_t stride = header.stride;
+
+  // The vectors are read with aligned loads in blocks of FLOATS_PER_BLOCK.
+  if (header.vectors_offset % ALIGNMENT != 0 || stride % FLOATS_PER_BLOCK != 0 ||
+      (n_words > 0 && (header.dimension == 0 || header.dimension > stride)))
+    return false;
+
+  // The vectors must end before the sorted rows. The stride is checked
+  // before it is multiplied by the size of a float.
+  if (header.sorted_rows_offset > size || header.vectors_offset > header.sorted_rows_offset ||
+      (n_words > 0 &&
+       (!fits(header.vectors_offset, stride, sizeof(float), header.sorted_rows_offset) ||
+        !fits(header.vectors_offset, n_words, stride * sizeof(float), header.sorted_rows_offset))))
+    return false;
+
+  // n_words is checked before n_words + 1 is formed.
+  if (!fits(header.sorted_rows_offset, n_words, sizeof(std::uint64_t), size) ||
+      !fits(header.token_offsets_offset, n_words, sizeof(std::uint64_t), size) ||
+      !fits(header.token_offsets_offset, n_words + 1, sizeof(std::uint64_t), size) ||
+      header.tokens_offset > size)
+    return false;
+
+  if (header.sorted_rows_offset % sizeof(std::uint64_t) != 0 ||
+      header.token_offsets_offset % sizeof(std::uint64_t) != 0)
+    return false;
+
+  const std::uint64_t* sorted_rows =
+    reinterpret_cast<const std::uint64_t*>(base + header.sorted_rows_offset);
+  const std::uint64_t* token_offsets =
+    reinterpret_cast<const std::uint64_t*>(base + header.token_offsets_offset);
+
+  for (std::uint64_t i = 0; i < n_words; ++i) {
+    if (sorted_rows[i] >= n_words) return false;
+  }
+
+  // Every token must lie within the token section.
+  for (std::uint64_t row = 0; row < n_words; ++row) {
+    if (token_offsets[row] > token_offsets[row + 1]) return false;
+  }
+
+  return token_offsets[n_words] <= size - header.tokens_offset;
+}
+
+WordVectors::size_type WordVectors::size() const {
+  return header_->n_words;
+}
+
+WordVectors::size_type WordVectors::dimension() const {
+  return header_->dimension;
+}
+
+std::int64_t WordVectors::find(const std::string& token) const {
+  std::uint64_t lo = 0;
+  std::uint64_t hi = header_->n_words;
+
+  while (lo < hi) {
+    std::uint64_t mid = lo + (hi - lo) / 2;
+    std::uint64_t row = sorted_rows_[mid];
+    int order = token.compare(0, std::string::npos,
+                              tokens_ + token_offsets_[row],
+                              token_offsets_[row + 1] - token_offsets_[row]);
+
+    if (order == 0) return row;
+    if (order < 0) hi = mid;
+    else lo = mid + 1;
+  }
+
+  return NONE;
+}
+
+const float* WordVectors::at(WordVectors::size_type row) const {
+  if (row >= header_->n_words)
+    throw std::out_of_range("word vector row " + std::to_string(row) + " does not exist");
+
+  return vectors_ + row * header_->stride;
+}
+
+DoubleVector WordVectors::coherence(const std::vector<std::vector<std::int64_t>>& topic_rows,
+                                    WordVectors::size_type n_threads) const {
+  DoubleVector coherence(topic_rows.size());
+
+  parallel_for(0, topic_rows.size(), n_threads, [&](std::size_t topic, std::size_t) {
+    std::vector<const float*> vectors;
+    for (auto row : topic_rows[topic]) {
+      if (row != NONE) vectors.push_back(at(row));
+    }
+
+    std::size_t n = vectors.size();
+    if (n < 2) {
+      coherence[topic] = std::numeric_limits<double>::quiet_NaN();
+      return;
+    }
+
+    double sum = 0;
+    double dots[4];
+
+    for (std::size_t i = 0; i < n; ++i) {
+      std::size_t j = i + 1;
+
+      for (; j + 4 <= n; j += 4) {
+        dot4(vectors[i], &vectors[j], header_->stride, dots);
+        sum += dots[0] + dots[1] + dots[2] + dots[3];
+      }
+
+      for (; j < n; ++j) sum += dot(vectors[i], vectors[j], header_->stride);
+    }
+
+    coherence[topic] = sum / (n * (n - 1) / 2);
+  });
+
+  return coherence;
+}
@@ -0,0 +1,80 @@
+#ifndef WORD_VECTORS_H
+#define WORD_VECTORS_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "def.h"
+
+// Pretrained word vectors mapped read-only from a file for embedding-based
+// coherence. Vectors are converted once from the word2vec binary or the
+// GloVe text format into a binary file in which every vector is normalized
+// to unit length and padded to a multiple of 16 floats on a 64-byte boundary,
+// so the cosine similarity of two words is a plain aligned dot product.
+class WordVectors {
+public:
+  using SPtr = std::shared_ptr<const WordVectors>;
+  using size_type = std::size_t;
+
+  enum class Format {
+    WORD2VEC,   // "<n> <dimension>\n" followed by "<word> <float32 x dimension>"
+    TEXT        // lines of "<word> <value> ... <value>", as GloVe and fastText write
+  };
+
+  static const std::int64_t NONE = -1;
+
+  ~WordVectors();
+
+  static void convert(const std::string& input, const std::string& output, Format format);
+  static SPtr open(const std::string& path);
+
+  size_type size() const;
+  size_type dimension() const;
+
+  // Row of the vector of a token, NONE if there is none.
+  std::int64_t find(const std::string& token) const;
+
+  const float* at(size_type row) const;
+
+  // Mean cosine similarity over all pairs of distinct rows of every topic.
+  // Rows that are NONE are skipped, topics with fewer than two vectors get
+  // NaN. Topics are scored in parallel.
+  DoubleVector coherence(const std::vector<std::vector<std::int64_t>>& topic_rows,
+                         size_type n_threads) const;
+
+private:
+  struct Header {
+    char magic[8];
+    std::uint64_t n_words;
+    std::uint64_t dimension;
+    std::uint64_t stride;
+    std::uint64_t vectors_offset;
+    std::uint64_t sorted_rows_offset;
+    std::uint64_t token_offsets_offset;
+    std::uint64_t tokens_offset;
+    std::uint64_t size;
+  };
+
+  void* mapping_;
+  size_type mapping_size_;
+
+  const Header* header_;
+  const float* vectors_;
+  const std::uint64_t* sorted_rows_;
+  const std::uint64_t* token_offsets_;
+  const char* tokens_;
+
+  WordVectors(void* mapping, size_type size);
+
+  // Whether every section of the header lies within its size, which open
+  // has checked against the mapped size.
+  static bool is_valid(const Header& header, const char* base);
+
+  WordVectors(const WordVectors& other) = delete;
+  WordVectors& operator=(const WordVectors& rhs) = delete;
+
+};
+
+#endif // WORD_VECTORS_H